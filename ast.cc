@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 
@@ -14,11 +15,39 @@ Binary::operator std::string() {
   return "(" + string(*left) + op.lexeme + string(*right) + ")";
 }
 
+InitList::operator std::string() {
+  string content;
+  for (size_t i = 0; i < elems.size(); i++) {
+    if (i) content += ", ";
+    content += string(*elems[i]);
+  }
+  return "{" + content + "}";
+}
+
+Logical::operator std::string() {
+  return "(" + string(*left) + op.lexeme + string(*right) + ")";
+}
+
+Conditional::operator std::string() {
+  return "(" + string(*cond) + "?" + string(*thenExpr) + ":" +
+         string(*elseExpr) + ")";
+}
+
 Unary::operator std::string() { return op.lexeme + string(*child); }
 
+CompoundAssign::operator std::string() {
+  return "(" + string(*target) + op.lexeme + string(*value) + ")";
+}
+
+IncDec::operator std::string() {
+  return prefix ? op.lexeme + string(*target) : string(*target) + op.lexeme;
+}
+
 Integer::operator std::string() {
   std::stringstream ss;
   ss << value;
+  if (isUnsigned) ss << 'u';
+  if (isLong) ss << 'l';
   return ss.str();
 }
 
@@ -28,6 +57,12 @@ Double::operator std::string() {
   return ss.str();
 }
 
+Float::operator std::string() {
+  std::stringstream ss;
+  ss << value << 'f';
+  return ss.str();
+}
+
 String::operator std::string() { return value; }
 
 Char::operator std::string() {
@@ -38,7 +73,15 @@ Char::operator std::string() {
 
 Integer::Integer(Token token) {
   std::stringstream ss(token.lexeme);
-  ss >> value;
+  unsigned long long v;
+  ss >> v;
+  for (auto c : token.lexeme) {
+    if (c == 'u' || c == 'U') isUnsigned = true;
+    if (c == 'l' || c == 'L') isLong = true;
+  }
+  // like C, a literal that doesn't fit in int is long
+  if (v > (isUnsigned ? UINT32_MAX : INT32_MAX)) isLong = true;
+  value = v;
 }
 
 Double::Double(Token token) {
@@ -46,6 +89,11 @@ Double::Double(Token token) {
   ss >> value;
 }
 
+Float::Float(Token token) {
+  std::stringstream ss(token.lexeme);
+  ss >> value;
+}
+
 Boolean::operator std::string() { return value ? "true" : "false"; }
 
 Char::Char(Token token) {
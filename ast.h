@@ -1,5 +1,6 @@
 #ifndef __EXPR_H__
 #define __EXPR_H__
+#include <set>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,7 @@ class ExprStmt : public Statement {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 typedef std::vector<Declaration*> Program;
@@ -52,6 +54,8 @@ class BlockStmt : public Statement {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
+  friend class LoopNestVisitor;
 };
 
 class IfStmt : public Statement {
@@ -73,6 +77,22 @@ class IfStmt : public Statement {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+// Hints for the optimizer from the pragmas before a loop. Fields left at zero
+// are up to the optimizer's cost models. The `clox` ones are carried out by
+// LoopNestVisitor on the nest the loop starts.
+struct LoopHints {
+  bool unroll = false;      // #pragma unroll
+  bool unrollFull = false;  // unroll full
+  int unrollCount = 0;      // unroll(N), 1 disables unrolling
+  bool vectorize = false;   // vectorize(enable)
+  int vectorizeWidth = 0;   // vectorize_width(N), 1 disables vectorization
+  int interleaveCount = 0;  // interleave_count(N)
+  bool interchange = false;  // clox interchange
+  std::vector<int> tile;     // clox tile(N, ...), sizes from the outermost loop
+  int unrollAndJam = 0;      // clox unroll_and_jam(N)
 };
 
 class WhileStmt : public Statement {
@@ -80,18 +100,50 @@ class WhileStmt : public Statement {
   Expr* condition;
   Statement* body;
   Statement* update;
+  LoopHints hints;
+  int line;  // of the `while` or `for`
 
  public:
-  WhileStmt(Expr* condition, Statement* body, Statement* update = nullptr)
-      : condition(condition), body(body), update(update){};
+  WhileStmt(Expr* condition, Statement* body, Statement* update = nullptr,
+            LoopHints hints = {}, int line = 0)
+      : condition(condition),
+        body(body),
+        update(update),
+        hints(hints),
+        line(line){};
   Expr* getCondition() const { return condition; };
   Statement* getBody() const { return body; };
   Statement* getUpdate() const { return update; };
+  LoopHints getHints() const { return hints; };
+  int getLine() const { return line; };
   operator std::string() override { return "whilestmt"; };
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+struct SwitchCase {
+  Expr* label;  // nullptr for `default`
+  Program body;
+};
+
+class SwitchStmt : public Statement {
+ protected:
+  Expr* condition;
+  std::vector<SwitchCase> cases;
+
+ public:
+  SwitchStmt(Expr* condition, std::vector<SwitchCase> cases)
+      : condition(condition), cases(cases){};
+  Expr* getCondition() const { return condition; };
+  const std::vector<SwitchCase>& getCases() const { return cases; };
+  operator std::string() override { return "switchstmt"; };
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class BreakStmt : public Statement {
@@ -124,6 +176,7 @@ class ReturnStmt : public Statement {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class VarDecl : public Declaration {
@@ -131,11 +184,13 @@ class VarDecl : public Declaration {
   Type type;
   std::string identifier;
   Expr* init;
+  bool isStatic;
 
  public:
-  VarDecl(Type type, std::string id, Expr* init)
-      : type(type), identifier(id), init(init){};
+  VarDecl(Type type, std::string id, Expr* init, bool isStatic = false)
+      : type(type), identifier(id), init(init), isStatic(isStatic){};
   Type getType() const { return type; };
+  bool getStatic() const { return isStatic; };
   std::string name() const { return identifier; };
   Expr* getInit() const { return init; };
   operator std::string() override {
@@ -145,6 +200,7 @@ class VarDecl : public Declaration {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 typedef std::vector<TypedVar> Args;
@@ -155,10 +211,18 @@ class FunDecl : public Declaration {
   Args args;
   BlockStmt* body;
   Type retType;
+  bool isStatic;
+  std::set<std::string> addressTaken;  // variables `&` is applied to
 
  public:
-  FunDecl(std::string id, Args args, BlockStmt* body, Type retType)
-      : identifier(id), args(args), body(body), retType(retType){};
+  FunDecl(std::string id, Args args, BlockStmt* body, Type retType,
+          bool isStatic = false, std::set<std::string> addressTaken = {})
+      : identifier(id),
+        args(args),
+        body(body),
+        retType(retType),
+        isStatic(isStatic),
+        addressTaken(addressTaken){};
   operator std::string() override { return "function " + identifier; };
 
   std::string name() const { return identifier; };
@@ -168,6 +232,7 @@ class FunDecl : public Declaration {
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class PrintVisitor;
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 typedef std::vector<Expr*> RealArgs;
@@ -184,21 +249,40 @@ class Call : public Expr {
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class Index : public Expr {
   Expr* base;
   std::vector<Expr*> idxs;
+  int line;
 
  public:
-  Index(Expr* base, std::vector<Expr*> idxs) : base(base), idxs(idxs){};
+  Index(Expr* base, std::vector<Expr*> idxs, int line = 0)
+      : base(base), idxs(idxs), line(line){};
   Expr* getBase() const { return base; };
   std::vector<Expr*> getIdxs() const { return idxs; };
+  int getLine() const { return line; };
   operator std::string() override { return "index " + std::string(*base); };
   bool isLval() const override { return true; }
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+class InitList : public Expr {
+  std::vector<Expr*> elems;
+
+ public:
+  InitList(std::vector<Expr*> elems) : elems(elems){};
+  std::vector<Expr*> getElems() const { return elems; };
+  operator std::string() override;
+  bool isLval() const override { return false; }
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class Binary : public Expr {
@@ -218,6 +302,48 @@ class Binary : public Expr {
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+// `left && right` or `left || right`, evaluated with short circuit
+class Logical : public Expr {
+ protected:
+  Expr* left;
+  Token op;
+  Expr* right;
+
+ public:
+  Logical(Expr* left, Token op, Expr* right)
+      : left(left), op(op), right(right){};
+  Token getOp() const { return op; };
+  Expr* getLeft() const { return left; };
+  Expr* getRight() const { return right; };
+  operator std::string() override;
+  bool isLval() const override { return false; }
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+class Conditional : public Expr {
+ protected:
+  Expr* cond;
+  Expr* thenExpr;
+  Expr* elseExpr;
+
+ public:
+  Conditional(Expr* cond, Expr* thenExpr, Expr* elseExpr)
+      : cond(cond), thenExpr(thenExpr), elseExpr(elseExpr){};
+  Expr* getCond() const { return cond; };
+  Expr* getThen() const { return thenExpr; };
+  Expr* getElse() const { return elseExpr; };
+  operator std::string() override;
+  bool isLval() const override { return false; }
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class Unary : public Expr {
@@ -230,26 +356,53 @@ class Unary : public Expr {
   Token getOp() const { return op; };
   Expr* getChild() const { return child; };
   operator std::string() override;
+  bool isLval() const override { return op.tokenType == STAR; }
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+  friend class FoldVisitor;
+};
+
+// `target op= value`. op is the arithmetic operator, e.g. PLUS for `+=`
+class CompoundAssign : public Expr {
+ protected:
+  Expr* target;
+  Token op;
+  Expr* value;
+
+ public:
+  CompoundAssign(Expr* target, Token op, Expr* value)
+      : target(target), op(op), value(value){};
+  Token getOp() const { return op; };
+  Expr* getTarget() const { return target; };
+  Expr* getValue() const { return value; };
+  operator std::string() override;
   bool isLval() const override { return false; }
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
-class Postfix : public Expr {
+// `++target`, `--target`, `target++` or `target--`
+class IncDec : public Expr {
  protected:
   Token op;
-  Expr* child;
+  Expr* target;
+  bool prefix;
 
  public:
-  Postfix(Token op, Expr* child) : op(op), child(child){};
+  IncDec(Token op, Expr* target, bool prefix)
+      : op(op), target(target), prefix(prefix){};
   Token getOp() const { return op; };
-  Expr* getChild() const { return child; };
-  operator std::string() override { return "postfix " + op.lexeme; };
+  Expr* getTarget() const { return target; };
+  bool isPrefix() const { return prefix; };
+  operator std::string() override;
   bool isLval() const override { return false; }
 
   void accept(AstVisitor* v) override { v->visit(this); }
   friend class CodeGenVisitor;
+  friend class FoldVisitor;
 };
 
 class Literal : public Expr {
@@ -259,12 +412,16 @@ class Literal : public Expr {
 
 class Integer : public Literal {
  protected:
-  int value;
+  long long value;
+  bool isLong = false;  // 64-bit, from an `l` suffix or a value beyond int
+  bool isUnsigned = false;
 
  public:
   Integer(Token token);
   Integer(int value) : value(value){};
-  int getValue() const { return value; };
+  long long getValue() const { return value; };
+  bool getLong() const { return isLong; };
+  bool getUnsigned() const { return isUnsigned; };
   operator std::string() override;
 
   void accept(AstVisitor* v) override { v->visit(this); }
@@ -285,6 +442,20 @@ class Double : public Literal {
   friend class CodeGenVisitor;
 };
 
+class Float : public Literal {
+ protected:
+  float value;
+
+ public:
+  Float(Token token);
+  Float(float value) : value(value){};
+  float getValue() const { return value; }
+  operator std::string() override;
+
+  void accept(AstVisitor* v) override { v->visit(this); }
+  friend class CodeGenVisitor;
+};
+
 class String : public Literal {
  protected:
   std::string value;
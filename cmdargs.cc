@@ -4,7 +4,36 @@
 #include <iostream>
 #include <string>
 
-const std::string usage = "Usage: clox [source]\n";
+const std::string usage =
+    "Usage: clox [options] [source]\n"
+    "Options:\n"
+    "  -fno-ssa  keep scalar locals in stack slots instead of SSA values\n"
+    "  -fargument-noalias\n"
+    "            assume array parameters never overlap, as if restrict\n"
+    "  -fwrapv   make signed integer overflow wrap around\n"
+    "  -fno-strict-aliasing\n"
+    "            let objects be accessed through any type\n"
+    "  -ffast-math\n"
+    "            all of the floating-point options below\n"
+    "  -fassociative-math\n"
+    "            reassociate floating-point operations\n"
+    "  -fno-honor-nans\n"
+    "            assume floating-point values are never NaN\n"
+    "  -fno-honor-infinities\n"
+    "            assume floating-point values are never infinite\n"
+    "  -fno-signed-zeros\n"
+    "            ignore the sign of floating-point zeros\n"
+    "  -freciprocal-math\n"
+    "            replace division by multiplication with the reciprocal\n"
+    "  -ffp-contract=fast|off\n"
+    "            fuse multiplies and adds, e.g. into FMA\n"
+    "  -fwhole-program\n"
+    "            give the globals of a program with main internal linkage\n"
+    "  -Wperf    warn about array accesses in loops that make poor use of the\n"
+    "            cache\n"
+    "  -Rfold    report how many AST nodes constant folding eliminated\n"
+    "  -Rloop-nest\n"
+    "            report which loop nests the clox pragmas transformed\n";
 
 CmdArgs::CmdArgs(int argc, char** argv) {
   compile_ = true;
@@ -19,9 +48,64 @@ CmdArgs::CmdArgs(int argc, char** argv) {
     printIR_ = true;
   }
 
-  if (argc == 2) {
-    fileName = std::string(argv[1]);
-  } else {
+  ssa_ = true;
+  argumentNoalias_ = false;
+  wrapv_ = false;
+  strictAliasing_ = true;
+  reassoc_ = noNaNs_ = noInfs_ = noSignedZeros_ = reciprocal_ = false;
+  contract_ = approxFunc_ = false;
+  warnPerf_ = false;
+  wholeProgram_ = false;
+  remarkFold_ = remarkLoopNest_ = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg == "-fssa")
+      ssa_ = true;
+    else if (arg == "-fno-ssa")
+      ssa_ = false;
+    else if (arg == "-fargument-noalias")
+      argumentNoalias_ = true;
+    else if (arg == "-fwrapv")
+      wrapv_ = true;
+    else if (arg == "-fstrict-aliasing")
+      strictAliasing_ = true;
+    else if (arg == "-fno-strict-aliasing")
+      strictAliasing_ = false;
+    else if (arg == "-ffast-math")
+      reassoc_ = noNaNs_ = noInfs_ = noSignedZeros_ = reciprocal_ = contract_ =
+          approxFunc_ = true;
+    else if (arg == "-fassociative-math")
+      reassoc_ = true;
+    else if (arg == "-fno-honor-nans")
+      noNaNs_ = true;
+    else if (arg == "-fno-honor-infinities")
+      noInfs_ = true;
+    else if (arg == "-fno-signed-zeros")
+      noSignedZeros_ = true;
+    else if (arg == "-freciprocal-math")
+      reciprocal_ = true;
+    else if (arg == "-ffp-contract=fast")
+      contract_ = true;
+    else if (arg == "-ffp-contract=off")
+      contract_ = false;
+    else if (arg == "-fwhole-program")
+      wholeProgram_ = true;
+    else if (arg == "-Wperf")
+      warnPerf_ = true;
+    else if (arg == "-Rfold")
+      remarkFold_ = true;
+    else if (arg == "-Rloop-nest")
+      remarkLoopNest_ = true;
+    else if (arg[0] != '-' && fileName.empty())
+      fileName = arg;
+    else {
+      std::cerr << "Unknown option " << arg << std::endl << usage;
+      exit(-1);
+    }
+  }
+
+  if (fileName.empty()) {
     std::cerr << usage;
     exit(-1);
   }
@@ -6,6 +6,22 @@ class CmdArgs {
   bool printLex_;
   bool compile_;
   bool link_;
+  bool ssa_;
+  bool argumentNoalias_;
+  bool wrapv_;
+  bool strictAliasing_;
+  // floating-point optimizations C doesn't allow by default
+  bool reassoc_;
+  bool noNaNs_;
+  bool noInfs_;
+  bool noSignedZeros_;
+  bool reciprocal_;
+  bool contract_;
+  bool approxFunc_;
+  bool warnPerf_;
+  bool wholeProgram_;
+  bool remarkFold_;
+  bool remarkLoopNest_;
   std::string fileName;
 
  public:
@@ -15,6 +31,21 @@ class CmdArgs {
   bool printLex() { return printLex_; };
   bool compile() { return compile_; };
   bool link() { return link_; };
+  bool ssa() { return ssa_; };
+  bool argumentNoalias() { return argumentNoalias_; };
+  bool wrapv() { return wrapv_; };
+  bool strictAliasing() { return strictAliasing_; };
+  bool reassoc() { return reassoc_; };
+  bool noNaNs() { return noNaNs_; };
+  bool noInfs() { return noInfs_; };
+  bool noSignedZeros() { return noSignedZeros_; };
+  bool reciprocal() { return reciprocal_; };
+  bool contract() { return contract_; };
+  bool approxFunc() { return approxFunc_; };
+  bool warnPerf() { return warnPerf_; };
+  bool wholeProgram() { return wholeProgram_; };
+  bool remarkFold() { return remarkFold_; };
+  bool remarkLoopNest() { return remarkLoopNest_; };
   std::string getFileName() { return fileName; };
 };
 extern CmdArgs* options;
@@ -9,11 +9,13 @@
 
 class FunDecl;
 class Literal;
+class SSABuilder;
 
 struct Record {
   std::string id;
   Type type;
-  llvm::AllocaInst* addr;
+  llvm::Value* addr;
+  int ssa = -1;  // the SSABuilder variable if it isn't kept in memory
 };
 
 struct Trace {
@@ -21,6 +23,7 @@ struct Trace {
   FunDecl* fun;
   llvm::BasicBlock* contB;
   llvm::BasicBlock* endB;
+  SSABuilder* ssa;
 };
 
 class Scope {
@@ -0,0 +1,616 @@
+#include "fold.h"
+
+#include <cassert>
+#include <cstdint>
+
+#include "ast.h"
+
+// Counts the nodes of an AST. Used to report how many nodes folding removed.
+class CountVisitor : public AstVisitor {
+ public:
+  int count = 0;
+
+  void visitProgram(const Program& prog) {
+    for (auto d : prog) visit(d);
+  }
+
+  void visit(Declaration* d) override { d->accept(this); }
+  void visit(ExprStmt* st) override {
+    count++;
+    visit(st->getExpr());
+  }
+  void visit(VarDecl* d) override {
+    count++;
+    if (d->getInit()) visit(d->getInit());
+  }
+  void visit(FunDecl* d) override {
+    count++;
+    if (d->getBody()) visit(d->getBody());
+  }
+  void visit(BlockStmt* d) override {
+    count++;
+    visitProgram(d->getProgram());
+  }
+  void visit(IfStmt* d) override {
+    count++;
+    visit(d->getCondition());
+    visit(d->getTrue());
+    if (d->getFalse()) visit(d->getFalse());
+  }
+  void visit(WhileStmt* d) override {
+    count++;
+    visit(d->getCondition());
+    visit(d->getBody());
+    if (d->getUpdate()) visit(d->getUpdate());
+  }
+  void visit(SwitchStmt* d) override {
+    count++;
+    visit(d->getCondition());
+    for (auto& c : d->getCases()) {
+      if (c.label) visit(c.label);
+      visitProgram(c.body);
+    }
+  }
+  void visit(BreakStmt* d) override { count++; }
+  void visit(ContStmt* d) override { count++; }
+  void visit(ReturnStmt* d) override {
+    count++;
+    if (d->getExpr()) visit(d->getExpr());
+  }
+
+  void visit(Expr* expr) override { expr->accept(this); }
+  void visit(Literal* expr) override { expr->accept(this); }
+  void visit(Integer* expr) override { count++; }
+  void visit(Double* expr) override { count++; }
+  void visit(Float* expr) override { count++; }
+  void visit(Boolean* expr) override { count++; }
+  void visit(Char* expr) override { count++; }
+  void visit(String* expr) override { count++; }
+  void visit(Binary* expr) override {
+    count++;
+    visit(expr->getLeft());
+    visit(expr->getRight());
+  }
+  void visit(Logical* expr) override {
+    count++;
+    visit(expr->getLeft());
+    visit(expr->getRight());
+  }
+  void visit(Conditional* expr) override {
+    count++;
+    visit(expr->getCond());
+    visit(expr->getThen());
+    visit(expr->getElse());
+  }
+  void visit(Unary* expr) override {
+    count++;
+    visit(expr->getChild());
+  }
+  void visit(CompoundAssign* expr) override {
+    count++;
+    visit(expr->getTarget());
+    visit(expr->getValue());
+  }
+  void visit(IncDec* expr) override {
+    count++;
+    visit(expr->getTarget());
+  }
+  void visit(Variable* expr) override { count++; }
+  void visit(Call* expr) override {
+    count++;
+    visit(expr->getCallee());
+    for (auto a : expr->getArgs()) visit(a);
+  }
+  void visit(Index* expr) override {
+    count++;
+    visit(expr->getBase());
+    for (auto i : expr->getIdxs()) visit(i);
+  }
+  void visit(InitList* expr) override {
+    count++;
+    for (auto e : expr->getElems()) visit(e);
+  }
+};
+
+// The value of a literal together with the type it is generated with.
+struct LiteralValue {
+  Type::Base base;
+  long long i;
+  double d;
+};
+
+static bool getLiteral(Expr* e, LiteralValue& c) {
+  auto n = dynamic_cast<Integer*>(e);
+  if (n && (n->getLong() || n->getUnsigned()))
+    return false;  // long and unsigned literals are left to code generation
+  if (n)
+    c = {Type::Base::INT, n->getValue(), 0};
+  else if (auto x = dynamic_cast<Char*>(e))
+    c = {Type::Base::CHAR, (int8_t)x->getValue(), 0};
+  else if (auto x = dynamic_cast<Boolean*>(e))
+    c = {Type::Base::BOOL, x->getValue(), 0};
+  else if (auto x = dynamic_cast<Double*>(e))
+    c = {Type::Base::DOUBLE, 0, x->getValue()};
+  else if (auto x = dynamic_cast<Float*>(e))
+    c = {Type::Base::FLOAT, 0, x->getValue()};
+  else
+    return false;
+  return true;
+}
+
+// the order of the usual arithmetic conversions in CodeGenVisitor::binaryOp
+static int rank(Type::Base b) {
+  switch (b) {
+    case Type::Base::BOOL:
+      return 1;
+    case Type::Base::CHAR:
+      return 2;
+    case Type::Base::SHORT:
+      return 3;
+    case Type::Base::INT:
+      return 4;
+    case Type::Base::LONG:
+      return 5;
+    case Type::Base::FLOAT:
+      return 6;
+    case Type::Base::DOUBLE:
+      return 7;
+    default:
+      return 0;
+  }
+}
+
+static bool isFloating(Type::Base b) {
+  return b == Type::Base::FLOAT || b == Type::Base::DOUBLE;
+}
+
+// truncate v to the width of an integer type, as the generated code does
+static long long wrap(long long v, Type::Base b) {
+  if (b == Type::Base::CHAR) return (int8_t)(uint8_t)v;
+  return (int32_t)(uint32_t)v;
+}
+
+static bool isComparison(TokenType t) {
+  return t == LESS || t == LESS_EQUAL || t == GREATER || t == GREATER_EQUAL ||
+         t == EQUAL_EQUAL || t == BANG_EQUAL;
+}
+
+void FoldVisitor::visitProgram(Program& prog) {
+  CountVisitor before;
+  before.visitProgram(prog);
+
+  scopes.push_back({});
+  foldProgram(prog);
+  scopes.pop_back();
+
+  CountVisitor after;
+  after.visitProgram(prog);
+  eliminated = before.count - after.count;
+}
+
+void FoldVisitor::foldProgram(Program& prog) {
+  for (size_t i = 0; i < prog.size(); i++) {
+    prog[i] = fold(prog[i]);
+    if (dynamic_cast<ReturnStmt*>(prog[i]) ||
+        dynamic_cast<BreakStmt*>(prog[i]) || dynamic_cast<ContStmt*>(prog[i])) {
+      prog.resize(i + 1);  // the rest is unreachable
+      break;
+    }
+  }
+}
+
+Expr* FoldVisitor::fold(Expr* e) {
+  if (!e) return nullptr;
+  expr = e;
+  e->accept(this);
+  return expr;
+}
+
+Declaration* FoldVisitor::fold(Declaration* d) {
+  if (!d) return nullptr;
+  decl = d;
+  d->accept(this);
+  return decl;
+}
+
+Statement* FoldVisitor::fold(Statement* s) {
+  auto ret = dynamic_cast<Statement*>(fold(static_cast<Declaration*>(s)));
+  assert(!s || ret);
+  return ret;
+}
+
+// The base type and signedness an expression is generated with. The base is
+// VOID if it is unknown.
+Type FoldVisitor::typeOf(Expr* e) {
+  auto make = [](Type::Base base, bool isUnsigned = false) {
+    Type t = {base};
+    t.isUnsigned = isUnsigned;
+    return t;
+  };
+  LiteralValue c;
+  if (getLiteral(e, c)) return make(c.base);
+
+  auto lookup = [&make, this](Expr* e, size_t idxs) {
+    auto v = dynamic_cast<Variable*>(e);
+    if (!v) return make(Type::Base::VOID);
+    for (auto it = scopes.rbegin(); it != scopes.rend(); it++) {
+      auto t = it->find(v->getName());
+      if (t == it->end()) continue;
+      // a pointer is indexed like a one-dimensional array
+      size_t rank = t->second.isPointer ? 1 : t->second.dims.size();
+      if (rank != idxs) return make(Type::Base::VOID);
+      return make(t->second.base, t->second.isUnsigned);
+    }
+    return make(Type::Base::VOID);
+  };
+  // the usual arithmetic conversions: the operand of higher rank wins, and
+  // unsigned wins between two of the same rank
+  auto common = [&make](Type l, Type r) {
+    if (rank(l.base) != rank(r.base))
+      return rank(l.base) > rank(r.base) ? l : r;
+    return make(l.base, l.isUnsigned || r.isUnsigned);
+  };
+
+  if (dynamic_cast<Variable*>(e)) return lookup(e, 0);
+  if (auto i = dynamic_cast<Index*>(e))
+    return lookup(i->getBase(), i->getIdxs().size());
+  if (auto call = dynamic_cast<Call*>(e)) {
+    auto v = dynamic_cast<Variable*>(call->getCallee());
+    if (v && funs.count(v->getName()) && !funs[v->getName()].isPointer) {
+      auto& f = funs[v->getName()];
+      return make(f.base, f.isUnsigned);
+    }
+    return make(Type::Base::VOID);
+  }
+  if (dynamic_cast<Logical*>(e)) return make(Type::Base::BOOL);
+  if (auto c = dynamic_cast<Conditional*>(e)) {
+    auto t = typeOf(c->getThen()), f = typeOf(c->getElse());
+    if (!rank(t.base) || !rank(f.base))
+      return t == f ? t : make(Type::Base::VOID);
+    return common(t, f);
+  }
+  if (auto u = dynamic_cast<Unary*>(e)) {
+    auto op = u->getOp().tokenType;
+    if (op == STAR || op == AMPERSAND) return make(Type::Base::VOID);
+    return op == BANG ? make(Type::Base::BOOL) : typeOf(u->getChild());
+  }
+  if (auto a = dynamic_cast<CompoundAssign*>(e)) return typeOf(a->getTarget());
+  if (auto a = dynamic_cast<IncDec*>(e)) return typeOf(a->getTarget());
+  if (auto b = dynamic_cast<Binary*>(e)) {
+    auto op = b->getOp().tokenType;
+    if (op == EQUAL) return typeOf(b->getLeft());
+    if (isComparison(op)) return make(Type::Base::BOOL);
+    auto l = typeOf(b->getLeft()), r = typeOf(b->getRight());
+    if (!rank(l.base) || !rank(r.base)) return make(Type::Base::VOID);
+    // a shift has the type of its left operand
+    auto t = op == LESS_LESS || op == GREATER_GREATER ? l : common(l, r);
+    // types narrower than int are promoted to int
+    return rank(t.base) < rank(Type::Base::INT) ? make(Type::Base::INT) : t;
+  }
+  return make(Type::Base::VOID);
+}
+
+// Evaluate `left op right` if both are literals, or return nullptr.
+Expr* FoldVisitor::foldBinary(Token op, Expr* left, Expr* right) {
+  LiteralValue a, b;
+  if (!getLiteral(left, a) || !getLiteral(right, b)) return nullptr;
+  // i1 operands keep their own type through the integer upgrade; leave them
+  if (a.base == Type::Base::BOOL || b.base == Type::Base::BOOL) return nullptr;
+
+  if (isFloating(a.base) || isFloating(b.base)) {
+    // float op float and float op integer stay float, as in C
+    bool isFloat = a.base != Type::Base::DOUBLE && b.base != Type::Base::DOUBLE;
+    auto operand = [isFloat](const LiteralValue& c) -> double {
+      double v = isFloating(c.base) ? c.d : c.i;
+      return isFloat ? (float)v : v;
+    };
+    auto make = [isFloat](double r) -> Expr* {
+      if (isFloat) return new Float((float)r);
+      return new Double(r);
+    };
+    double x = operand(a), y = operand(b);
+    switch (op.tokenType) {
+      case PLUS:
+        return make(x + y);
+      case MINUS:
+        return make(x - y);
+      case STAR:
+        return make(x * y);
+      case SLASH:
+        return make(x / y);
+      case LESS:
+        return new Boolean(x < y);
+      case LESS_EQUAL:
+        return new Boolean(x <= y);
+      case GREATER:
+        return new Boolean(x > y);
+      case GREATER_EQUAL:
+        return new Boolean(x >= y);
+      case EQUAL_EQUAL:
+        return new Boolean(x == y);
+      case BANG_EQUAL:
+        return new Boolean(x != y);
+      default:
+        return nullptr;
+    }
+  }
+
+  auto base = Type::Base::INT;  // char operands are promoted to int
+  long long x = a.i, y = b.i, r = 0;
+  switch (op.tokenType) {
+    case PLUS:
+      r = x + y;
+      break;
+    case MINUS:
+      r = x - y;
+      break;
+    case STAR:
+      r = x * y;
+      break;
+    case SLASH:
+    case PERCENT:
+      // division by zero and overflowing division are left to run time
+      if (y == 0 || wrap(x / y, base) != x / y) return nullptr;
+      r = op.tokenType == SLASH ? x / y : x % y;
+      break;
+    case AMPERSAND:
+      r = x & y;
+      break;
+    case PIPE:
+      r = x | y;
+      break;
+    case CARET:
+      r = x ^ y;
+      break;
+    case LESS_LESS:
+    case GREATER_GREATER:
+      // out of range shift amounts are left to run time
+      if (y < 0 || y >= 32) return nullptr;
+      r = op.tokenType == LESS_LESS ? (long long)((unsigned long long)x << y)
+                                    : x >> y;
+      break;
+    case LESS:
+      return new Boolean(x < y);
+    case LESS_EQUAL:
+      return new Boolean(x <= y);
+    case GREATER:
+      return new Boolean(x > y);
+    case GREATER_EQUAL:
+      return new Boolean(x >= y);
+    case EQUAL_EQUAL:
+      return new Boolean(x == y);
+    case BANG_EQUAL:
+      return new Boolean(x != y);
+    default:
+      return nullptr;
+  }
+  return new Integer((int)wrap(r, base));
+}
+
+// Simplify `x + 0`, `x - 0`, `x * 1`, `x / 1`, `x | 0`, `x ^ 0`, `x << 0` and
+// `x >> 0` to `x`, or return nullptr.
+// Only done when the literal doesn't change the type of the result, and not
+// for `x + 0` on floating point, which turns -0.0 into 0.0.
+Expr* FoldVisitor::simplify(Token op, Expr* left, Expr* right) {
+  auto keepsType = [this](Expr* x, const LiteralValue& c) {
+    auto t = typeOf(x).base;
+    if (c.base == Type::Base::BOOL) return false;
+    return (t == Type::Base::INT || t == Type::Base::LONG || isFloating(t)) &&
+           rank(c.base) <= rank(t);
+  };
+  auto is = [](const LiteralValue& c, int v) {
+    return isFloating(c.base) ? c.d == v : c.i == v;
+  };
+  auto isInt = [this](Expr* x) { return typeOf(x).base == Type::Base::INT; };
+
+  LiteralValue c;
+  auto t = op.tokenType;
+  if (getLiteral(right, c) && keepsType(left, c)) {
+    if ((t == PLUS && is(c, 0) && isInt(left)) || (t == MINUS && is(c, 0)) ||
+        ((t == STAR || t == SLASH) && is(c, 1)))
+      return left;
+    if ((t == PIPE || t == CARET || t == LESS_LESS || t == GREATER_GREATER) &&
+        is(c, 0) && isInt(left))
+      return left;
+  }
+  if (getLiteral(left, c) && keepsType(right, c)) {
+    if ((t == PLUS && is(c, 0) && isInt(right)) || (t == STAR && is(c, 1)))
+      return right;
+    if ((t == PIPE || t == CARET) && is(c, 0) && isInt(right)) return right;
+  }
+  return nullptr;
+}
+
+void FoldVisitor::visit(Declaration* d) { d->accept(this); }
+
+void FoldVisitor::visit(ExprStmt* st) {
+  st->expr = fold(st->expr);
+  decl = st;
+}
+
+void FoldVisitor::visit(VarDecl* st) {
+  st->init = fold(st->init);
+  scopes.back()[st->identifier] = st->type;
+  decl = st;
+}
+
+void FoldVisitor::visit(FunDecl* st) {
+  funs[st->identifier] = st->retType;
+  if (st->body) {
+    scopes.push_back({});
+    for (auto a : st->args) scopes.back()[a.id.lexeme] = a.type;
+    fold(st->body);
+    scopes.pop_back();
+  }
+  decl = st;
+}
+
+void FoldVisitor::visit(BlockStmt* st) {
+  scopes.push_back({});
+  foldProgram(st->decls);
+  scopes.pop_back();
+  decl = st;
+}
+
+void FoldVisitor::visit(IfStmt* st) {
+  st->condition = fold(st->condition);
+  st->true_branch = fold(st->true_branch);
+  st->false_branch = fold(st->false_branch);
+
+  LiteralValue c;
+  if (getLiteral(st->condition, c) && !isFloating(c.base)) {
+    if (c.i)
+      decl = st->true_branch;
+    else if (st->false_branch)
+      decl = st->false_branch;
+    else
+      decl = new BlockStmt({});
+  } else
+    decl = st;
+}
+
+void FoldVisitor::visit(WhileStmt* st) {
+  st->condition = fold(st->condition);
+  st->body = fold(st->body);
+  st->update = fold(st->update);
+
+  LiteralValue c;
+  if (getLiteral(st->condition, c) && !isFloating(c.base) && !c.i)
+    decl = new BlockStmt({});  // the loop never runs
+  else
+    decl = st;
+}
+
+void FoldVisitor::visit(SwitchStmt* st) {
+  st->condition = fold(st->condition);
+  scopes.push_back({});  // the cases share one scope
+  for (auto& c : st->cases) {
+    c.label = fold(c.label);
+    foldProgram(c.body);
+  }
+  scopes.pop_back();
+  decl = st;
+}
+
+void FoldVisitor::visit(BreakStmt* st) { decl = st; }
+
+void FoldVisitor::visit(ContStmt* st) { decl = st; }
+
+void FoldVisitor::visit(ReturnStmt* st) {
+  st->expr = fold(st->expr);
+  decl = st;
+}
+
+void FoldVisitor::visit(Expr* e) { e->accept(this); }
+
+void FoldVisitor::visit(Literal* e) { e->accept(this); }
+
+void FoldVisitor::visit(Integer* e) { expr = e; }
+
+void FoldVisitor::visit(Double* e) { expr = e; }
+
+void FoldVisitor::visit(Float* e) { expr = e; }
+
+void FoldVisitor::visit(Boolean* e) { expr = e; }
+
+void FoldVisitor::visit(Char* e) { expr = e; }
+
+void FoldVisitor::visit(String* e) { expr = e; }
+
+void FoldVisitor::visit(Binary* e) {
+  e->left = fold(e->left);
+  e->right = fold(e->right);
+  Expr* r = nullptr;
+  if (e->op.tokenType != EQUAL) {
+    r = foldBinary(e->op, e->left, e->right);
+    if (!r) r = simplify(e->op, e->left, e->right);
+  }
+  expr = r ? r : e;
+}
+
+// A literal left operand decides `&&` when false and `||` when true.
+void FoldVisitor::visit(Logical* e) {
+  e->left = fold(e->left);
+  e->right = fold(e->right);
+  expr = e;
+
+  LiteralValue a, b;
+  if (!getLiteral(e->left, a) || isFloating(a.base)) return;
+  bool isAnd = e->op.tokenType == AND;
+  if (isAnd != (bool)a.i)
+    expr = new Boolean(!isAnd);
+  else if (getLiteral(e->right, b) && !isFloating(b.base))
+    expr = new Boolean(b.i);
+}
+
+void FoldVisitor::visit(Conditional* e) {
+  e->cond = fold(e->cond);
+  e->thenExpr = fold(e->thenExpr);
+  e->elseExpr = fold(e->elseExpr);
+  expr = e;
+
+  // picking an arm must not change the type of the result, its signedness
+  // included
+  LiteralValue c;
+  auto t = typeOf(e->thenExpr), f = typeOf(e->elseExpr);
+  if (!getLiteral(e->cond, c) || t.base == Type::Base::VOID ||
+      t.base != f.base || t.isUnsigned != f.isUnsigned)
+    return;
+  bool taken = isFloating(c.base) ? c.d != 0 : c.i != 0;
+  expr = taken ? e->thenExpr : e->elseExpr;
+}
+
+void FoldVisitor::visit(Unary* e) {
+  e->child = fold(e->child);
+  expr = e;
+
+  LiteralValue c;
+  if (!getLiteral(e->child, c)) return;
+  auto op = e->op.tokenType;
+  if (op == MINUS) {
+    if (c.base == Type::Base::DOUBLE)
+      expr = new Double(-c.d);
+    else if (c.base == Type::Base::FLOAT)
+      expr = new Float(-c.d);
+    else if (c.base == Type::Base::INT)
+      expr = new Integer((int)wrap(-c.i, c.base));
+    else if (c.base == Type::Base::CHAR)
+      expr = new Char((char)wrap(-c.i, c.base));
+  } else if (op == BANG && !isFloating(c.base)) {
+    expr = new Boolean(!c.i);
+  } else if (op == TILDE) {
+    if (c.base == Type::Base::INT)
+      expr = new Integer((int)~c.i);
+    else if (c.base == Type::Base::CHAR)
+      expr = new Char((char)~c.i);
+  }
+}
+
+void FoldVisitor::visit(CompoundAssign* e) {
+  e->target = fold(e->target);
+  e->value = fold(e->value);
+  expr = e;
+}
+
+void FoldVisitor::visit(IncDec* e) {
+  e->target = fold(e->target);
+  expr = e;
+}
+
+void FoldVisitor::visit(Variable* e) { expr = e; }
+
+void FoldVisitor::visit(Call* e) {
+  for (auto& a : e->args) a = fold(a);
+  expr = e;
+}
+
+void FoldVisitor::visit(Index* e) {
+  e->base = fold(e->base);
+  for (auto& i : e->idxs) i = fold(i);
+  expr = e;
+}
+
+void FoldVisitor::visit(InitList* e) {
+  for (auto& x : e->elems) x = fold(x);
+  expr = e;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "visitor.h"
+
+// An optimization pass over the AST, run before CodeGenVisitor. It folds
+// constant arithmetic and comparisons, simplifies identities such as `x * 1`,
+// prunes `if`/`while` with constant conditions and drops statements after a
+// `return`, `break` or `continue`.
+class FoldVisitor : public AstVisitor {
+  Expr* expr = nullptr;         // replacement of the last visited expression
+  Declaration* decl = nullptr;  // replacement of the last visited declaration
+  int eliminated = 0;
+
+  // types of the variables and functions in scope, used by identities
+  std::vector<std::map<std::string, Type>> scopes;
+  std::map<std::string, Type> funs;
+
+  Expr* fold(Expr* e);
+  Statement* fold(Statement* s);
+  Declaration* fold(Declaration* d);
+  void foldProgram(Program& prog);
+
+  Type typeOf(Expr* e);
+  Expr* foldBinary(Token op, Expr* left, Expr* right);
+  Expr* simplify(Token op, Expr* left, Expr* right);
+
+ public:
+  void visitProgram(Program& prog);
+  int getEliminated() const { return eliminated; }
+
+  void visit(Declaration* d) override;
+
+  void visit(ExprStmt* st) override;
+  void visit(VarDecl* d) override;
+  void visit(FunDecl* d) override;
+  void visit(BlockStmt* d) override;
+  void visit(IfStmt* d) override;
+  void visit(WhileStmt* d) override;
+  void visit(SwitchStmt* d) override;
+  void visit(BreakStmt* d) override;
+  void visit(ContStmt* d) override;
+  void visit(ReturnStmt* d) override;
+
+  void visit(Expr* expr) override;
+  void visit(Literal* expr) override;
+  void visit(Integer* expr) override;
+  void visit(Double* expr) override;
+  void visit(Float* expr) override;
+  void visit(Boolean* expr) override;
+  void visit(Char* expr) override;
+  void visit(String* expr) override;
+  void visit(Binary* expr) override;
+  void visit(Logical* expr) override;
+  void visit(Conditional* expr) override;
+  void visit(Unary* expr) override;
+  void visit(CompoundAssign* expr) override;
+  void visit(IncDec* expr) override;
+  void visit(Variable* expr) override;
+  void visit(Call* expr) override;
+  void visit(Index* expr) override;
+  void visit(InitList* expr) override;
+};
@@ -1,28 +1,55 @@
 #include "llvm.h"
 
+#include "cmdargs.h"
+#include "llvm/IR/MDBuilder.h"
 #include "log.h"
 
 llvm::Type* llvmWrapper::getBool() { return llvm::Type::getInt1Ty(*ctx); }
+llvm::Type* llvmWrapper::getShort() { return llvm::Type::getInt16Ty(*ctx); }
 llvm::Type* llvmWrapper::getInt() { return llvm::Type::getInt32Ty(*ctx); }
+llvm::Type* llvmWrapper::getLong() { return llvm::Type::getInt64Ty(*ctx); }
 llvm::Type* llvmWrapper::getChar() { return llvm::Type::getInt8Ty(*ctx); }
+llvm::Type* llvmWrapper::getFloat() { return llvm::Type::getFloatTy(*ctx); }
 llvm::Type* llvmWrapper::getDouble() { return llvm::Type::getDoubleTy(*ctx); }
 llvm::Type* llvmWrapper::getVoid() { return llvm::Type::getVoidTy(*ctx); }
 
 llvm::Type* llvmWrapper::getType(Type type) {
   auto baseType = getBaseType(type);
-  if (type.isArray)
-    return llvm::ArrayType::get(baseType, type.arraySize);
-  else if (type.isPointer)
+  if (type.isArray) {
+    // a[d0][d1] is [d0 x [d1 x base]], so GEPs keep the dimension structure.
+    // An array parameter points to its first row, [d1 x base]*.
+    llvm::Type* t = baseType;
+    auto outer = type.dims.rend() - (type.isPointer ? 1 : 0);
+    for (auto it = type.dims.rbegin(); it != outer; it++)
+      t = llvm::ArrayType::get(t, *it);
+    return type.isPointer ? t->getPointerTo() : t;
+  } else if (type.isPointer)
     return baseType->getPointerTo();
   else
     return baseType;
 }
 
 llvm::Type* llvmWrapper::getBaseType(Type type) {
+  if (type.lanes) {  // int4 is <4 x i32>
+    if (type.base == Type::Base::BOOL || type.base == Type::Base::VOID)
+      abortMsg("invalid element type of a vector");
+    Type element = type;
+    element.lanes = 0;
+    return llvm::FixedVectorType::get(getBaseType(element), type.lanes);
+  }
   switch (type.base) {
+    case Type::Base::SHORT:
+      return getShort();
+      break;
     case Type::Base::INT:
       return getInt();
       break;
+    case Type::Base::LONG:
+      return getLong();
+      break;
+    case Type::Base::FLOAT:
+      return getFloat();
+      break;
     case Type::Base::DOUBLE:
       return getDouble();
       break;
@@ -43,6 +70,9 @@ llvm::Type* llvmWrapper::getBaseType(Type type) {
 llvm::Value* llvmWrapper::convertToTruthy(llvm::Value* v) {
   auto t = v->getType();
   if (t == getBool()) return v;
+  if (t->isFloatingPointTy())
+    return builder->CreateFCmpUNE(v, llvm::ConstantFP::get(t, 0.0));
+  if (t->isPointerTy()) return builder->CreateIsNotNull(v);
   if (t->isIntegerTy()) {
     int w = t->getIntegerBitWidth();
     return builder->CreateICmpNE(
@@ -63,22 +93,180 @@ llvm::AllocaInst* llvmWrapper::createEntryBlockAlloca(llvm::Function* fun,
   return TmpB.CreateAlloca(type, num, name.c_str());
 }
 
-llvm::Value* llvmWrapper::implictConvert(llvm::Value* v, llvm::Type* t) {
+/// getConstantData - Get a private, unnamed_addr constant global holding init.
+/// Constants are uniqued by the context, so identical data share one global.
+llvm::GlobalVariable* llvmWrapper::getConstantData(llvm::Constant* init,
+                                                   const std::string& name) {
+  auto it = constData->find(init);
+  if (it != constData->end()) return it->second;
+  auto g = new llvm::GlobalVariable(*mod, init->getType(), true,
+                                    llvm::GlobalValue::PrivateLinkage, init,
+                                    name);
+  g->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  g->setAlignment(mod->getDataLayout().getPrefTypeAlign(init->getType()));
+  (*constData)[init] = g;
+  return g;
+}
+
+/// getSplatByte - If every byte of c has the same value, return that byte as
+/// an i8 so that c can be stored with a memset. Otherwise return nullptr.
+llvm::Value* llvmWrapper::getSplatByte(llvm::Constant* c) {
+  if (c->isNullValue()) return builder->getInt8(0);
+  auto seq = llvm::dyn_cast<llvm::ConstantDataSequential>(c);
+  if (!seq) return nullptr;
+  auto bytes = seq->getRawDataValues();
+  if (bytes.empty() || bytes.find_first_not_of(bytes[0]) != bytes.npos)
+    return nullptr;
+  return builder->getInt8(bytes[0]);
+}
+
+/// decayArray - Turn a pointer to a (nested) array into a pointer to its first
+/// scalar element. Other pointers are returned unchanged.
+llvm::Value* llvmWrapper::decayArray(llvm::Value* ptr) {
+  auto t = ptr->getType()->getPointerElementType();
+  if (!t->isArrayTy()) return ptr;
+  std::vector<llvm::Value*> idxs = {builder->getInt32(0)};
+  for (; t->isArrayTy(); t = t->getArrayElementType())
+    idxs.push_back(builder->getInt32(0));
+  return builder->CreateInBoundsGEP(ptr->getType()->getPointerElementType(),
+                                    ptr, idxs, "decay");
+}
+
+llvm::Value* llvmWrapper::implictConvert(llvm::Value* v, llvm::Type* t,
+                                         bool isUnsigned) {
   if (v->getType() == t) return v;
-  if (t->isDoubleTy()) {
-    return builder->CreateSIToFP(v, t, "todouble");
+  if (auto vt = llvm::dyn_cast<llvm::FixedVectorType>(t)) {
+    auto from = llvm::dyn_cast<llvm::FixedVectorType>(v->getType());
+    if (!from)  // a scalar is splat across the lanes
+      return builder->CreateVectorSplat(
+          vt->getNumElements(),
+          implictConvert(v, vt->getElementType(), isUnsigned), "splat");
+    if (from->getNumElements() != vt->getNumElements())
+      abortMsg("can't convert between vectors of different lengths");
+    // element by element, as the scalars would be
+    auto e = vt->getElementType(), fe = from->getElementType();
+    if (e->isFloatingPointTy() && fe->isFloatingPointTy())
+      return builder->CreateFPCast(v, t, "tofp");
+    if (e->isFloatingPointTy())
+      return isUnsigned ? builder->CreateUIToFP(v, t, "tofp")
+                        : builder->CreateSIToFP(v, t, "tofp");
+    if (fe->isFloatingPointTy())
+      abortMsg("can't implict convert floating point into int");
+    return builder->CreateIntCast(v, t, !isUnsigned, "toint");
+  }
+  if (v->getType()->isVectorTy())
+    abortMsg("can't convert a vector into a scalar");
+  if (t->isFloatingPointTy()) {
+    if (v->getType()->isFloatingPointTy())
+      return builder->CreateFPCast(v, t, "tofp");
+    if (isUnsigned || v->getType() == getBool())
+      return builder->CreateUIToFP(v, t, "tofp");
+    return builder->CreateSIToFP(v, t, "tofp");
   } else if (t == getBool()) {
     return convertToTruthy(v);
   } else if (t->isIntegerTy()) {
     if (!v->getType()->isIntegerTy())
-      abortMsg("can't implict convert double into int");
+      abortMsg("can't implict convert floating point into int");
     else
-      return builder->CreateIntCast(v, t, true, "toint");
+      return builder->CreateIntCast(
+          v, t, !isUnsigned && v->getType() != getBool(), "toint");
   } else if (t->isArrayTy()) {
     return v;
   } else if (t->isPointerTy()) {
-    return builder->CreateGEP(v, 0);
+    // an array decays to a pointer to its first row or element, one
+    // dimension at a time; 0 is a null pointer
+    while (v->getType() != t && v->getType()->isPointerTy() &&
+           v->getType()->getPointerElementType()->isArrayTy())
+      v = builder->CreateConstInBoundsGEP2_32(
+          v->getType()->getPointerElementType(), v, 0, 0, "decay");
+    if (v->getType() == t) return v;
+    auto zero = llvm::dyn_cast<llvm::ConstantInt>(v);
+    if (zero && zero->isZero())
+      return llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(t));
+    abortMsg("incompatible pointer types");
   }
   abortMsg("unimplemented implict convert");
   return nullptr;
 }
+
+// With -fwhole-program, a module that defines main is the whole program: no
+// other object refers to its global variables, so they can all have internal
+// linkage.
+void llvmWrapper::internalizeGlobals() {
+  auto main = mod->getFunction("main");
+  if (!options->wholeProgram() || !main || main->empty()) return;
+  for (auto& g : mod->globals())
+    // private constants such as string literals stay out of the symbol table
+    if (!g.isDeclaration() && !g.hasLocalLinkage())
+      g.setLinkage(llvm::GlobalValue::InternalLinkage);
+}
+
+// Tag a load or store of a scalar of type t for type-based alias analysis:
+// accesses to different base types never alias, except through char.
+// Signedness doesn't matter, and all pointers share one type.
+void llvmWrapper::setTBAA(llvm::Instruction* access, const Type& t) {
+  if (!options->strictAliasing()) return;
+  llvm::MDBuilder md(*ctx);
+  auto root = md.createTBAARoot("Simple C/C++ TBAA");
+  auto charNode = md.createTBAAScalarTypeNode("omnipotent char", root);
+  const char* name = nullptr;  // char and anything else alias everything
+  if (t.isPointer) {
+    name = "any pointer";
+  } else if (t.lanes) {
+    // a vector aliases its elements, which are accessed with their own type
+  } else {
+    switch (t.base) {
+      case Type::Base::SHORT:
+        name = "short";
+        break;
+      case Type::Base::INT:
+        name = "int";
+        break;
+      case Type::Base::LONG:
+        name = "long";
+        break;
+      case Type::Base::FLOAT:
+        name = "float";
+        break;
+      case Type::Base::DOUBLE:
+        name = "double";
+        break;
+      case Type::Base::BOOL:
+        name = "_Bool";
+        break;
+      default:
+        break;
+    }
+  }
+  auto node = name ? md.createTBAAScalarTypeNode(name, charNode) : charNode;
+  access->setMetadata(llvm::LLVMContext::MD_tbaa,
+                      md.createTBAAStructTagNode(node, node, 0));
+}
+
+// The floating-point optimizations enabled on the command line. The builder
+// puts them on every floating-point instruction it creates.
+llvm::FastMathFlags llvmWrapper::fastMathFlags() {
+  llvm::FastMathFlags fmf;
+  fmf.setAllowReassoc(options->reassoc());
+  fmf.setNoNaNs(options->noNaNs());
+  fmf.setNoInfs(options->noInfs());
+  fmf.setNoSignedZeros(options->noSignedZeros());
+  fmf.setAllowReciprocal(options->reciprocal());
+  fmf.setAllowContract(options->contract());
+  fmf.setApproxFunc(options->approxFunc());
+  return fmf;
+}
+
+// The same options as function attributes, which the backend reads.
+void llvmWrapper::addFPAttributes(llvm::Function* fun) {
+  auto fmf = fastMathFlags();
+  auto flag = [fun](const char* name, bool on) {
+    if (on) fun->addFnAttr(name, "true");
+  };
+  flag("no-nans-fp-math", fmf.noNaNs());
+  flag("no-infs-fp-math", fmf.noInfs());
+  flag("no-signed-zeros-fp-math", fmf.noSignedZeros());
+  flag("approx-func-fp-math", fmf.approxFunc());
+  flag("unsafe-fp-math", fmf.allowReassoc() && fmf.noSignedZeros() &&
+                            fmf.allowReciprocal());
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <map>
+
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
@@ -17,20 +20,37 @@ struct llvmWrapper {
   std::shared_ptr<llvm::LLVMContext> ctx;
   std::shared_ptr<llvm::Module> mod;
   std::shared_ptr<llvm::IRBuilder<>> builder;
+  std::shared_ptr<std::map<llvm::Constant*, llvm::GlobalVariable*>> constData;
   llvmWrapper() {
     ctx = std::make_shared<llvm::LLVMContext>();
     mod = std::make_shared<llvm::Module>("mod", *ctx);
     builder = std::make_shared<llvm::IRBuilder<>>(*ctx);
+    builder->setFastMathFlags(fastMathFlags());
+    constData =
+        std::make_shared<std::map<llvm::Constant*, llvm::GlobalVariable*>>();
   };
+  void setTBAA(llvm::Instruction* access, const Type& t);
+  static llvm::FastMathFlags fastMathFlags();
+  static void addFPAttributes(llvm::Function* fun);
   llvm::Type* getBool();
+  llvm::Type* getShort();
   llvm::Type* getInt();
+  llvm::Type* getLong();
   llvm::Type* getChar();
+  llvm::Type* getFloat();
   llvm::Type* getDouble();
   llvm::Type* getVoid();
   llvm::Type* getType(Type t);
   llvm::Type* getBaseType(Type t);
   llvm::Value* convertToTruthy(llvm::Value*);
-  llvm::Value* implictConvert(llvm::Value*, llvm::Type*);
+  // isUnsigned is the signedness of an integer value being converted
+  llvm::Value* implictConvert(llvm::Value*, llvm::Type*,
+                              bool isUnsigned = false);
+  llvm::GlobalVariable* getConstantData(llvm::Constant* init,
+                                        const std::string& name = ".str");
+  llvm::Value* getSplatByte(llvm::Constant* c);
+  llvm::Value* decayArray(llvm::Value* ptr);
+  void internalizeGlobals();
   llvm::AllocaInst* createEntryBlockAlloca(llvm::Function* fun,
                                            llvm::Type* type,
                                            const std::string& name,
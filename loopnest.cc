@@ -0,0 +1,674 @@
+#include "loopnest.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <set>
+
+#include "ast.h"
+#include "cmdargs.h"
+
+// A loop `for (int iv = lo; iv < hi; iv++)` as the parser desugars it.
+struct Loop {
+  VarDecl* init;  // `int iv = lo`
+  WhileStmt* loop;
+  std::string iv;
+  Expr* hi;
+};
+
+// A read or write of a variable declared outside the loop body, with the
+// subscripts if it is an array element.
+struct Access {
+  std::string name;
+  std::vector<Expr*> idxs;
+  bool write;
+};
+
+struct Nest {
+  std::vector<Loop> loops;  // from the outermost
+  Statement* body;          // of the innermost loop
+  // the direction vectors of the dependences, -1, 0 or 1 for each loop
+  std::set<std::vector<int>> deps;
+  // for each loop, how far in elements its iterations move the accesses
+  std::vector<long long> stride;
+};
+
+// Collects the accesses of a loop body. unsafe is set by what the analysis
+// can't see through: calls, pointers, jumps and static locals.
+class AccessVisitor : public AstVisitor {
+  bool write = false;  // the expression visited is assigned to
+
+  void target(Expr* e) {
+    write = true;
+    visit(e);
+    write = false;
+  }
+
+ public:
+  std::vector<Access> accesses;
+  std::set<std::string> locals;  // declared in the body
+  bool unsafe = false;
+
+  void visit(Declaration* d) override { d->accept(this); }
+  void visit(ExprStmt* st) override { visit(st->getExpr()); }
+  void visit(VarDecl* d) override {
+    if (d->getStatic()) unsafe = true;
+    if (d->getInit()) visit(d->getInit());
+    locals.insert(d->name());
+  }
+  void visit(FunDecl* d) override { unsafe = true; }
+  void visit(BlockStmt* d) override {
+    for (auto x : d->getProgram()) visit(x);
+  }
+  void visit(IfStmt* d) override {
+    visit(d->getCondition());
+    visit(d->getTrue());
+    if (d->getFalse()) visit(d->getFalse());
+  }
+  void visit(WhileStmt* d) override {
+    visit(d->getCondition());
+    visit(d->getBody());
+    if (d->getUpdate()) visit(d->getUpdate());
+  }
+  void visit(SwitchStmt* d) override { unsafe = true; }
+  void visit(BreakStmt* d) override { unsafe = true; }
+  void visit(ContStmt* d) override { unsafe = true; }
+  void visit(ReturnStmt* d) override { unsafe = true; }
+
+  void visit(Expr* expr) override { expr->accept(this); }
+  void visit(Literal* expr) override { expr->accept(this); }
+  void visit(Integer* expr) override {}
+  void visit(Double* expr) override {}
+  void visit(Float* expr) override {}
+  void visit(Boolean* expr) override {}
+  void visit(Char* expr) override {}
+  void visit(String* expr) override {}
+  void visit(Binary* expr) override {
+    if (expr->getOp().tokenType == EQUAL)
+      target(expr->getLeft());
+    else
+      visit(expr->getLeft());
+    visit(expr->getRight());
+  }
+  void visit(Logical* expr) override {
+    visit(expr->getLeft());
+    visit(expr->getRight());
+  }
+  void visit(Conditional* expr) override {
+    visit(expr->getCond());
+    visit(expr->getThen());
+    visit(expr->getElse());
+  }
+  void visit(Unary* expr) override {
+    auto op = expr->getOp().tokenType;
+    if (op == STAR || op == AMPERSAND) unsafe = true;
+    visit(expr->getChild());
+  }
+  void visit(CompoundAssign* expr) override {
+    target(expr->getTarget());
+    visit(expr->getValue());
+  }
+  void visit(IncDec* expr) override { target(expr->getTarget()); }
+  void visit(Variable* expr) override {
+    if (!locals.count(expr->getName()))
+      accesses.push_back({expr->getName(), {}, write});
+  }
+  void visit(Call* expr) override { unsafe = true; }
+  void visit(Index* expr) override {
+    bool w = write;
+    write = false;
+    auto base = dynamic_cast<Variable*>(expr->getBase());
+    if (!base)
+      unsafe = true;
+    else if (!locals.count(base->getName()))
+      accesses.push_back({base->getName(), expr->getIdxs(), w});
+    for (auto i : expr->getIdxs()) visit(i);
+  }
+  void visit(InitList* expr) override {
+    for (auto e : expr->getElems()) visit(e);
+  }
+};
+
+static bool isVariable(Expr* e, const std::string& name) {
+  auto v = dynamic_cast<Variable*>(e);
+  return v && v->getName() == name;
+}
+
+static bool isIntegral(const Type& t) {
+  if (t.isArray || t.isPointer) return false;
+  switch (t.base) {
+    case Type::Base::SHORT:
+    case Type::Base::INT:
+    case Type::Base::LONG:
+    case Type::Base::CHAR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Match d against `{ int iv = lo; while (iv < hi) body, update iv++ }`.
+static bool canonicalLoop(Declaration* d, Loop& l) {
+  auto b = dynamic_cast<BlockStmt*>(d);
+  if (!b || b->getProgram().size() != 2) return false;
+  auto init = dynamic_cast<VarDecl*>(b->getProgram()[0]);
+  auto w = dynamic_cast<WhileStmt*>(b->getProgram()[1]);
+  if (!init || !w || !init->getInit() || !isIntegral(init->getType()))
+    return false;
+  auto iv = init->name();
+  auto cond = dynamic_cast<Binary*>(w->getCondition());
+  if (!cond || cond->getOp().tokenType != LESS ||
+      !isVariable(cond->getLeft(), iv))
+    return false;
+
+  auto update = dynamic_cast<ExprStmt*>(w->getUpdate());
+  Expr* u = update ? update->getExpr() : nullptr;
+  auto inc = dynamic_cast<IncDec*>(u);
+  auto add = dynamic_cast<CompoundAssign*>(u);
+  auto one = add ? dynamic_cast<Integer*>(add->getValue()) : nullptr;
+  bool step = (inc && inc->getOp().tokenType == PLUSPLUS &&
+               isVariable(inc->getTarget(), iv)) ||
+              (add && add->getOp().tokenType == PLUS &&
+               isVariable(add->getTarget(), iv) && one &&
+               one->getValue() == 1);
+  if (!step) return false;
+  l = {init, w, iv, cond->getRight()};
+  return true;
+}
+
+// The expression can be evaluated anywhere in the nest with the same result.
+static bool invariant(Expr* e, const std::set<std::string>& changing) {
+  if (dynamic_cast<Integer*>(e)) return true;
+  if (auto v = dynamic_cast<Variable*>(e)) return !changing.count(v->getName());
+  if (auto b = dynamic_cast<Binary*>(e))
+    return b->getOp().tokenType != EQUAL && invariant(b->getLeft(), changing) &&
+           invariant(b->getRight(), changing);
+  return false;
+}
+
+// A subscript `iv + offset` of the loop at level `loop`, or just `offset` when
+// loop is -1. affine is false for any other subscript.
+struct Subscript {
+  bool affine;
+  int loop;
+  long long offset;
+};
+
+static Subscript subscript(Expr* e, const std::map<std::string, int>& level) {
+  if (auto n = dynamic_cast<Integer*>(e)) return {true, -1, n->getValue()};
+  if (auto v = dynamic_cast<Variable*>(e)) {
+    auto it = level.find(v->getName());
+    if (it != level.end()) return {true, it->second, 0};
+  }
+  if (auto b = dynamic_cast<Binary*>(e)) {
+    auto op = b->getOp().tokenType;
+    auto l = subscript(b->getLeft(), level);
+    auto r = subscript(b->getRight(), level);
+    if (l.affine && r.affine && op == PLUS && (l.loop < 0 || r.loop < 0))
+      return {true, std::max(l.loop, r.loop), l.offset + r.offset};
+    if (l.affine && r.affine && op == MINUS && r.loop < 0)
+      return {true, l.loop, l.offset - r.offset};
+  }
+  return {false, -1, 0};
+}
+
+// Add the direction vectors of the dependences between a and b, which access
+// the same array, to deps. A loop whose distance the subscripts don't fix can
+// go in any direction.
+static void dependences(const Access& a, const Access& b,
+                        const std::map<std::string, int>& level,
+                        std::set<std::vector<int>>& deps) {
+  size_t depth = level.size();
+  std::vector<long long> dist(depth);
+  std::vector<bool> known(depth);
+  for (size_t p = 0; p < a.idxs.size() && p < b.idxs.size(); p++) {
+    auto sa = subscript(a.idxs[p], level), sb = subscript(b.idxs[p], level);
+    if (!sa.affine || !sb.affine) continue;
+    if (sa.loop < 0 && sb.loop < 0 && sa.offset != sb.offset)
+      return;  // never the same element
+    if (sa.loop < 0 || sa.loop != sb.loop) continue;
+    auto d = sa.offset - sb.offset;  // b reaches a's element d iterations later
+    if (known[sa.loop] && dist[sa.loop] != d) return;
+    known[sa.loop] = true;
+    dist[sa.loop] = d;
+  }
+
+  std::vector<int> v(depth);
+  std::function<void(size_t)> expand = [&](size_t k) {
+    if (k == depth) {
+      auto first = std::find_if(v.begin(), v.end(), [](int x) { return x; });
+      if (first == v.end()) return;  // in the same iteration
+      auto w = v;
+      if (*first < 0)
+        for (auto& x : w) x = -x;  // it is b that comes first
+      deps.insert(w);
+      return;
+    }
+    for (int x = -1; x <= 1; x++) {
+      if (known[k] && x != (dist[k] > 0) - (dist[k] < 0)) continue;
+      v[k] = x;
+      expand(k + 1);
+    }
+  };
+  expand(0);
+}
+
+// The loops can run in the order perm, from the outermost, without running a
+// dependence backwards.
+static bool legal(const Nest& n, const std::vector<int>& perm) {
+  for (auto& v : n.deps)
+    for (auto k : perm) {
+      if (v[k] < 0) return false;
+      if (v[k] > 0) break;
+    }
+  return true;
+}
+
+static LoopHints plain(LoopHints h) {
+  h.interchange = false;
+  h.tile.clear();
+  h.unrollAndJam = 0;
+  return h;
+}
+
+static BlockStmt* forLoop(VarDecl* init, Expr* cond, Statement* body,
+                          Statement* update, LoopHints hints, int line) {
+  return new BlockStmt({init, new WhileStmt(cond, body, update, hints, line)});
+}
+
+// The loops from `from` on around body.
+static Statement* rebuild(const std::vector<Loop>& loops, size_t from,
+                          Statement* body) {
+  for (size_t k = loops.size(); k-- > from;) {
+    auto w = loops[k].loop;
+    body = forLoop(loops[k].init, w->getCondition(), body, w->getUpdate(),
+                   plain(w->getHints()), w->getLine());
+  }
+  return body;
+}
+
+static Expr* add(Expr* e, int n) {
+  return new Binary(e, Token(PLUS, "+"), new Integer(n));
+}
+
+// A copy of e with the variable name replaced by with.
+static Expr* substitute(Expr* e, const std::string& name, Expr* with) {
+  auto sub = [&](Expr* x) { return substitute(x, name, with); };
+  if (auto v = dynamic_cast<Variable*>(e))
+    return v->getName() == name ? with : e;
+  if (auto x = dynamic_cast<Binary*>(e))
+    return new Binary(sub(x->getLeft()), x->getOp(), sub(x->getRight()));
+  if (auto x = dynamic_cast<Logical*>(e))
+    return new Logical(sub(x->getLeft()), x->getOp(), sub(x->getRight()));
+  if (auto x = dynamic_cast<Conditional*>(e))
+    return new Conditional(sub(x->getCond()), sub(x->getThen()),
+                           sub(x->getElse()));
+  if (auto x = dynamic_cast<Unary*>(e))
+    return new Unary(x->getOp(), sub(x->getChild()));
+  if (auto x = dynamic_cast<CompoundAssign*>(e))
+    return new CompoundAssign(sub(x->getTarget()), x->getOp(),
+                              sub(x->getValue()));
+  if (auto x = dynamic_cast<IncDec*>(e))
+    return new IncDec(x->getOp(), sub(x->getTarget()), x->isPrefix());
+  if (auto x = dynamic_cast<Index*>(e)) {
+    std::vector<Expr*> idxs;
+    for (auto i : x->getIdxs()) idxs.push_back(sub(i));
+    return new Index(sub(x->getBase()), idxs, x->getLine());
+  }
+  if (auto x = dynamic_cast<InitList*>(e)) {
+    std::vector<Expr*> elems;
+    for (auto i : x->getElems()) elems.push_back(sub(i));
+    return new InitList(elems);
+  }
+  return e;  // a literal
+}
+
+static Statement* substitute(Statement* s, const std::string& name,
+                             Expr* with);
+
+static Declaration* substitute(Declaration* d, const std::string& name,
+                               Expr* with) {
+  if (auto x = dynamic_cast<VarDecl*>(d))
+    return new VarDecl(x->getType(), x->name(),
+                       x->getInit() ? substitute(x->getInit(), name, with)
+                                    : nullptr);
+  return substitute(dynamic_cast<Statement*>(d), name, with);
+}
+
+static Statement* substitute(Statement* s, const std::string& name,
+                             Expr* with) {
+  if (!s) return nullptr;
+  if (auto x = dynamic_cast<ExprStmt*>(s))
+    return new ExprStmt(substitute(x->getExpr(), name, with));
+  if (auto x = dynamic_cast<BlockStmt*>(s)) {
+    Program p;
+    for (auto d : x->getProgram()) p.push_back(substitute(d, name, with));
+    return new BlockStmt(p);
+  }
+  if (auto x = dynamic_cast<IfStmt*>(s))
+    return new IfStmt(substitute(x->getCondition(), name, with),
+                      substitute(x->getTrue(), name, with),
+                      substitute(x->getFalse(), name, with));
+  if (auto x = dynamic_cast<WhileStmt*>(s))
+    return new WhileStmt(substitute(x->getCondition(), name, with),
+                         substitute(x->getBody(), name, with),
+                         substitute(x->getUpdate(), name, with),
+                         x->getHints(), x->getLine());
+  return s;
+}
+
+void LoopNestVisitor::visitProgram(Program& prog) {
+  scopes.push_back({});
+  for (auto d : prog) visit(d);
+  scopes.pop_back();
+}
+
+bool LoopNestVisitor::isGlobal(const std::string& name) {
+  for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+    if (it->count(name)) return it + 1 == scopes.rend();
+  return false;
+}
+
+void LoopNestVisitor::note(const Nest& n, const std::string& what) {
+  std::string ivs;
+  for (auto& l : n.loops) ivs += (ivs.empty() ? "" : ", ") + l.iv;
+  report.push_back("Loop nest (" + ivs + ") in " + fun + ": " + what);
+}
+
+// Find the perfect nest st starts and the dependences of its body.
+bool LoopNestVisitor::analyze(BlockStmt* st, Nest& n) {
+  Loop l;
+  Declaration* d = st;
+  while (canonicalLoop(d, l)) {
+    n.loops.push_back(l);
+    n.body = l.loop->getBody();
+    d = n.body;
+    auto b = dynamic_cast<BlockStmt*>(d);
+    if (b && b->getProgram().size() == 1) d = b->getProgram()[0];
+  }
+  if (n.loops.empty()) {
+    note(n, "not transformed, the loop isn't `for (int i = lo; i < hi; i++)`");
+    return false;
+  }
+
+  AccessVisitor av;
+  n.body->accept(&av);
+  std::map<std::string, int> level;
+  std::set<std::string> changing;
+  for (size_t k = 0; k < n.loops.size(); k++) {
+    level[n.loops[k].iv] = k;
+    changing.insert(n.loops[k].iv);
+    if (av.locals.count(n.loops[k].iv)) av.unsafe = true;
+  }
+  for (auto& a : av.accesses) {
+    if (a.write && level.count(a.name)) av.unsafe = true;
+    if (a.write) changing.insert(a.name);
+  }
+  if (av.unsafe) {
+    note(n, "not transformed, its body has calls, pointers, jumps or "
+            "assignments to the loop variables");
+    return false;
+  }
+  for (auto& l : n.loops)
+    if (!invariant(l.init->getInit(), changing) ||
+        !invariant(l.hi, changing)) {
+      note(n, "not transformed, its bounds change in the nest");
+      return false;
+    }
+
+  n.stride.assign(n.loops.size(), 0);
+  for (auto& a : av.accesses) {
+    if (a.idxs.empty()) continue;
+    auto t = lookup(scopes, a.name);
+    if (!t || !t->isArray || t->dims.size() != a.idxs.size()) {
+      note(n, "not transformed, it indexes something other than array "
+              "elements");
+      return false;
+    }
+    for (size_t p = 0; p < a.idxs.size(); p++) {
+      auto s = subscript(a.idxs[p], level);
+      if (!s.affine || s.loop < 0) continue;
+      long long stride = 1;
+      for (size_t q = p + 1; q < t->dims.size(); q++) stride *= t->dims[q];
+      n.stride[s.loop] += stride;
+    }
+  }
+
+  auto& acc = av.accesses;
+  for (size_t i = 0; i < acc.size(); i++)
+    for (size_t j = i; j < acc.size(); j++) {
+      if (!acc[i].write && !acc[j].write) continue;
+      if (acc[i].name == acc[j].name) {
+        dependences(acc[i], acc[j], level, n.deps);
+        continue;
+      }
+      // array parameters are pointers to whatever the caller passes, another
+      // parameter's array or a global one
+      auto mayAlias = [this](const std::string& name) {
+        auto t = lookup(scopes, name);
+        return t && t->isPointer && !t->isRestrict &&
+               !(t->isArray && options->argumentNoalias());
+      };
+      auto& a = acc[i].name;
+      auto& b = acc[j].name;
+      if ((mayAlias(a) && (mayAlias(b) || isGlobal(b))) ||
+          (mayAlias(b) && isGlobal(a))) {
+        note(n, "not transformed, " + acc[i].name + " and " + acc[j].name +
+                    " may overlap");
+        return false;
+      }
+    }
+  return true;
+}
+
+// Move the loops with the largest strides out, so the innermost one walks
+// the arrays along their rows.
+bool LoopNestVisitor::interchange(Nest& n) {
+  std::vector<int> perm(n.loops.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::stable_sort(perm.begin(), perm.end(),
+                   [&n](int a, int b) { return n.stride[a] > n.stride[b]; });
+  if (std::is_sorted(perm.begin(), perm.end())) {
+    note(n, "not interchanged, the loops are in order already");
+    return false;
+  }
+  if (!legal(n, perm)) {
+    note(n, "not interchanged, a dependence forbids it");
+    return false;
+  }
+
+  Nest m = n;
+  for (size_t k = 0; k < perm.size(); k++) {
+    m.loops[k] = n.loops[perm[k]];
+    m.stride[k] = n.stride[perm[k]];
+  }
+  m.deps.clear();
+  for (auto& v : n.deps) {
+    std::vector<int> w;
+    for (auto k : perm) w.push_back(v[k]);
+    m.deps.insert(w);
+  }
+  std::string order;
+  for (auto& l : m.loops) order += (order.empty() ? "" : ", ") + l.iv;
+  note(n, "interchanged to (" + order + ")");
+  n = m;
+  return true;
+}
+
+// Split each loop into one over tiles and one in the tile:
+//   for (int i.tile = lo; i.tile < hi; i.tile += N)
+//     ...
+//       for (int i = i.tile; i < hi && i < i.tile + N; i++)
+BlockStmt* LoopNestVisitor::tile(Nest& n, const std::vector<int>& sizes) {
+  for (auto& v : n.deps)
+    if (std::find(v.begin(), v.end(), -1) != v.end()) {
+      note(n, "not tiled, a dependence forbids it");
+      return nullptr;
+    }
+
+  auto size = [&sizes](size_t k) {
+    return k < sizes.size() ? sizes[k] : sizes.back();
+  };
+  Statement* body = n.body;
+  for (size_t k = n.loops.size(); k-- > 0;) {
+    auto& l = n.loops[k];
+    auto cond = new Logical(
+        l.loop->getCondition(), Token(AND, "&&"),
+        new Binary(new Variable(l.iv), Token(LESS, "<"),
+                   add(new Variable(l.iv + ".tile"), size(k))));
+    body = forLoop(
+        new VarDecl(l.init->getType(), l.iv, new Variable(l.iv + ".tile")),
+        cond, body, l.loop->getUpdate(), plain(l.loop->getHints()),
+        l.loop->getLine());
+  }
+  std::string tiles;
+  for (size_t k = n.loops.size(); k-- > 0;) {
+    auto& l = n.loops[k];
+    auto tv = l.iv + ".tile";
+    auto next = new CompoundAssign(new Variable(tv), Token(PLUS, "+"),
+                                   new Integer(size(k)));
+    body = forLoop(new VarDecl(l.init->getType(), tv, l.init->getInit()),
+                   new Binary(new Variable(tv), Token(LESS, "<"), l.hi), body,
+                   new ExprStmt(next), {}, l.loop->getLine());
+    tiles = std::to_string(size(k)) + (tiles.empty() ? "" : "x") + tiles;
+  }
+  note(n, "tiled by " + tiles);
+  return static_cast<BlockStmt*>(body);
+}
+
+// Unroll the outermost loop and fuse the copies of the inner loops:
+//   int i = lo;
+//   while (i + N - 1 < hi) { inner loops { body[i] ... body[i + N - 1] } }
+//   while (i < hi) { inner loops { body[i] } }
+BlockStmt* LoopNestVisitor::unrollAndJam(Nest& n, int count) {
+  std::vector<int> perm(n.loops.size());
+  std::iota(perm.begin(), perm.end(), 1);
+  perm.back() = 0;
+  if (!legal(n, perm)) {
+    note(n, "not unrolled and jammed, a dependence forbids it");
+    return nullptr;
+  }
+
+  auto& outer = n.loops[0];
+  Program jam;
+  for (int c = 0; c < count; c++)
+    jam.push_back(new BlockStmt(
+        {c ? substitute(n.body, outer.iv, add(new Variable(outer.iv), c))
+           : n.body}));
+  auto next = new CompoundAssign(new Variable(outer.iv), Token(PLUS, "+"),
+                                 new Integer(count));
+  auto unrolled = new WhileStmt(
+      new Binary(add(new Variable(outer.iv), count - 1), Token(LESS, "<"),
+                 outer.hi),
+      rebuild(n.loops, 1, new BlockStmt(jam)), new ExprStmt(next),
+      plain(outer.loop->getHints()), outer.loop->getLine());
+  auto rest = new WhileStmt(
+      outer.loop->getCondition(), rebuild(n.loops, 1, n.body),
+      outer.loop->getUpdate(), {}, outer.loop->getLine());
+  note(n, "unrolled and jammed by " + std::to_string(count));
+  return new BlockStmt({outer.init, unrolled, rest});
+}
+
+void LoopNestVisitor::transform(BlockStmt* st) {
+  auto w = st->decls.size() == 2 ? dynamic_cast<WhileStmt*>(st->decls[1])
+                                 : nullptr;
+  if (!w) return;
+  auto h = w->getHints();
+  if (!h.interchange && h.tile.empty() && h.unrollAndJam < 2) return;
+
+  Nest n;
+  if (!analyze(st, n)) return;
+  bool changed = h.interchange && interchange(n);
+  BlockStmt* b = nullptr;
+  if (!h.tile.empty())
+    b = tile(n, h.tile);
+  else if (h.unrollAndJam > 1)
+    b = unrollAndJam(n, h.unrollAndJam);
+  if (!b && changed) b = static_cast<BlockStmt*>(rebuild(n.loops, 0, n.body));
+  if (b) st->decls = b->getProgram();
+}
+
+void LoopNestVisitor::visit(Declaration* d) { d->accept(this); }
+
+void LoopNestVisitor::visit(ExprStmt* st) {}
+
+void LoopNestVisitor::visit(VarDecl* st) {
+  scopes.back()[st->name()] = st->getType();
+}
+
+void LoopNestVisitor::visit(FunDecl* st) {
+  if (!st->getBody()) return;
+  fun = st->name();
+  scopes.push_back({});
+  for (auto [type, token] : st->getArgs()) {
+    type.isPointer |= type.isArray;  // an array parameter is a pointer
+    scopes.back()[token.lexeme] = type;
+  }
+  visit(st->getBody());
+  scopes.pop_back();
+}
+
+// Nests are transformed inside out, after the loops in their bodies.
+void LoopNestVisitor::visit(BlockStmt* st) {
+  scopes.push_back({});
+  for (auto d : st->decls) visit(d);
+  scopes.pop_back();
+  transform(st);
+}
+
+void LoopNestVisitor::visit(IfStmt* st) {
+  visit(st->getTrue());
+  if (st->getFalse()) visit(st->getFalse());
+}
+
+void LoopNestVisitor::visit(WhileStmt* st) { visit(st->getBody()); }
+
+void LoopNestVisitor::visit(SwitchStmt* st) {
+  scopes.push_back({});
+  for (auto& c : st->getCases())
+    for (auto d : c.body) visit(d);
+  scopes.pop_back();
+}
+
+void LoopNestVisitor::visit(BreakStmt* st) {}
+
+void LoopNestVisitor::visit(ContStmt* st) {}
+
+void LoopNestVisitor::visit(ReturnStmt* st) {}
+
+// Expressions hold no loops.
+void LoopNestVisitor::visit(Expr* e) {}
+
+void LoopNestVisitor::visit(Literal* e) {}
+
+void LoopNestVisitor::visit(Integer* e) {}
+
+void LoopNestVisitor::visit(Double* e) {}
+
+void LoopNestVisitor::visit(Float* e) {}
+
+void LoopNestVisitor::visit(Boolean* e) {}
+
+void LoopNestVisitor::visit(Char* e) {}
+
+void LoopNestVisitor::visit(String* e) {}
+
+void LoopNestVisitor::visit(Binary* e) {}
+
+void LoopNestVisitor::visit(Logical* e) {}
+
+void LoopNestVisitor::visit(Conditional* e) {}
+
+void LoopNestVisitor::visit(Unary* e) {}
+
+void LoopNestVisitor::visit(CompoundAssign* e) {}
+
+void LoopNestVisitor::visit(IncDec* e) {}
+
+void LoopNestVisitor::visit(Variable* e) {}
+
+void LoopNestVisitor::visit(Call* e) {}
+
+void LoopNestVisitor::visit(Index* e) {}
+
+void LoopNestVisitor::visit(InitList* e) {}
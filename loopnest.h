@@ -0,0 +1,68 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "visitor.h"
+
+struct Nest;
+
+// Restructures the loop nests marked with `#pragma clox interchange`,
+// `tile(N, ...)` or `unroll_and_jam(N)` for better cache use. Run after
+// FoldVisitor. A nest is a perfect nest of `for (int i = lo; i < hi; i++)`
+// loops whose bounds don't change in it, and each transformation is checked
+// against the dependences between the array accesses of its body first.
+//
+// interchange reorders the loops so the one walking the last dimension of the
+// arrays is innermost, tile splits every loop into tiles of the given sizes
+// and unroll_and_jam(N) unrolls the outermost loop N times into the innermost
+// body.
+class LoopNestVisitor : public AstVisitor {
+  TypeScopes scopes;  // for the shapes of the arrays
+  std::string fun;  // the function being visited
+  std::vector<std::string> report;
+
+  bool isGlobal(const std::string& name);
+  void transform(BlockStmt* st);
+  bool analyze(BlockStmt* st, Nest& n);
+  bool interchange(Nest& n);
+  BlockStmt* tile(Nest& n, const std::vector<int>& sizes);
+  BlockStmt* unrollAndJam(Nest& n, int count);
+  void note(const Nest& n, const std::string& what);
+
+ public:
+  void visitProgram(Program& prog);
+  const std::vector<std::string>& getReport() const { return report; }
+
+  void visit(Declaration* d) override;
+
+  void visit(ExprStmt* st) override;
+  void visit(VarDecl* d) override;
+  void visit(FunDecl* d) override;
+  void visit(BlockStmt* d) override;
+  void visit(IfStmt* d) override;
+  void visit(WhileStmt* d) override;
+  void visit(SwitchStmt* d) override;
+  void visit(BreakStmt* d) override;
+  void visit(ContStmt* d) override;
+  void visit(ReturnStmt* d) override;
+
+  void visit(Expr* expr) override;
+  void visit(Literal* expr) override;
+  void visit(Integer* expr) override;
+  void visit(Double* expr) override;
+  void visit(Float* expr) override;
+  void visit(Boolean* expr) override;
+  void visit(Char* expr) override;
+  void visit(String* expr) override;
+  void visit(Binary* expr) override;
+  void visit(Logical* expr) override;
+  void visit(Conditional* expr) override;
+  void visit(Unary* expr) override;
+  void visit(CompoundAssign* expr) override;
+  void visit(IncDec* expr) override;
+  void visit(Variable* expr) override;
+  void visit(Call* expr) override;
+  void visit(Index* expr) override;
+  void visit(InitList* expr) override;
+};
@@ -3,8 +3,11 @@
 #include <string>
 
 #include "cmdargs.h"
+#include "fold.h"
+#include "loopnest.h"
 #include "object.h"
 #include "parser.h"
+#include "perf.h"
 #include "scanner.h"
 
 using namespace std;
@@ -18,13 +21,29 @@ int run(const string& s) {
     for (auto t : tokens) cerr << t << endl;
   Parser parser;
   auto stmts = parser.parse(tokens);
+  FoldVisitor fv;
+  fv.visitProgram(stmts);
+  if (options->remarkFold())
+    cerr << "Constant folding eliminated " << fv.getEliminated()
+         << " AST nodes\n";
+  LoopNestVisitor nv;
+  nv.visitProgram(stmts);
+  if (options->remarkLoopNest())
+    for (auto& r : nv.getReport()) cerr << r << endl;
+  if (options->warnPerf()) {
+    PerfVisitor pv;
+    pv.visitProgram(stmts);
+    for (auto& w : pv.getWarnings()) cerr << w << endl;
+  }
   Scope scope;
   llvmWrapper l;
+  setTarget(l.mod.get());
   CodeGenVisitor v(scope, l);
   for (auto s : stmts) {
     v.visit(s);
     cout << endl;
   }
+  l.internalizeGlobals();
   if (options->printIR()) l.mod->print(llvm::outs(), nullptr);
   compile(v);
 
@@ -50,5 +69,5 @@ int runFile(const string& file) {
 
 int main(int argc, char** argv) {
   options = new CmdArgs(argc, argv);
-  return runFile(string(argv[1]));
+  return runFile(options->getFileName());
 }
@@ -1,5 +1,6 @@
 #include "object.h"
 
+#include "cmdargs.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -11,7 +12,10 @@
 
 using namespace llvm;
 
-void object(CodeGenVisitor v) {
+// The machine of the host, which the object file is generated for.
+static TargetMachine* hostMachine() {
+  static TargetMachine* machine = nullptr;
+  if (machine) return machine;
   auto TargetTriple = sys::getDefaultTargetTriple();
   InitializeAllTargetInfos();
   InitializeAllTargets();
@@ -27,18 +31,27 @@ void object(CodeGenVisitor v) {
   // TargetRegistry or we have a bogus target triple.
   if (!Target) {
     errs() << Error;
-    return;
+    exit(-1);
   }
 
   auto CPU = "generic";
   auto Features = "";
 
   TargetOptions opt;
+  if (options->contract()) opt.AllowFPOpFusion = FPOpFusion::Fast;
   auto RM = Optional<Reloc::Model>();
-  auto TargetMachine =
-      Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
-  v.getMod()->setDataLayout(TargetMachine->createDataLayout());
-  v.getMod()->setTargetTriple(TargetTriple);
+  machine = Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+  return machine;
+}
+
+void setTarget(llvm::Module* mod) {
+  auto machine = hostMachine();
+  mod->setDataLayout(machine->createDataLayout());
+  mod->setTargetTriple(machine->getTargetTriple().str());
+}
+
+void object(CodeGenVisitor v) {
+  auto TargetMachine = hostMachine();
 
   auto Filename = "output.o";
   std::error_code EC;
@@ -1,3 +1,6 @@
 #pragma once
 #include "visitor.h"
+// Lay out the module for the host, before code is generated for it, so sizes
+// and alignments are the target's.
+void setTarget(llvm::Module* mod);
 void compile(CodeGenVisitor v);
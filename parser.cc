@@ -3,6 +3,7 @@
 #include <cassert>
 #include <cstdarg>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <stack>
 
@@ -64,31 +65,154 @@ std::vector<Declaration*> Parser::program() {
   return prog;
 }
 
+// A vector type is named by its element type and number of lanes, e.g. int4
+// or double2, as the ext_vector_type typedefs of OpenCL and clang are.
+static bool vectorType(const std::string& name, Type::Base& base, int& lanes) {
+  static const std::map<std::string, Type::Base> bases = {
+      {"char", Type::Base::CHAR}, {"short", Type::Base::SHORT},
+      {"int", Type::Base::INT},   {"long", Type::Base::LONG},
+      {"float", Type::Base::FLOAT}, {"double", Type::Base::DOUBLE}};
+  auto digits = name.find_first_of("0123456789");
+  if (digits == std::string::npos) return false;
+  auto it = bases.find(name.substr(0, digits));
+  auto n = name.substr(digits);
+  if (it == bases.end() || (n != "2" && n != "4" && n != "8" && n != "16"))
+    return false;
+  base = it->second;
+  lanes = std::stoi(n);
+  return true;
+}
+
+bool Parser::typeName() {
+  Type::Base base;
+  int lanes;
+  return match(12, VAR, CONST, UNSIGNED, SIGNED, SHORT, LONG, INT, DOUBLE,
+               FLOAT, CHAR, BOOL, VOID) ||
+         (match(1, IDENTIFIER) && vectorType(peek().lexeme, base, lanes));
+}
+
 Declaration* Parser::decl() {
   Declaration* d = nullptr;
   TypedVar var;
-  switch (peek().tokenType) {
-    case VAR:
-    case INT:
-    case DOUBLE:
-    case FLOAT:
-    case CHAR:
-    case BOOL:
-    case VOID:
-      var = typedVar();
-      if (match(1, LEFT_PAREN))
-        d = funDecl(var.type, var.id);
-      else
-        d = varDecl(var.type, var.id);
-      break;
-    default:
-      d = stmt();
-      break;
+  bool isStatic = false;
+  if (match(1, PRAGMA)) return pragmaDecl();
+  if (match(1, STATIC)) {
+    advance();
+    isStatic = true;
+  }
+  if (typeName()) {
+    var = typedVar();
+    if (match(1, LEFT_PAREN))
+      d = funDecl(var.type, var.id, isStatic);
+    else
+      d = varDecl(var.type, var.id, isStatic);
+  } else {
+    if (isStatic) {
+      std::cerr << "line " << peek().line
+                << ": Expect a declaration after `static`" << std::endl;
+      exit(-1);
+    }
+    d = stmt();
   }
   assert(d);
   return d;
 }
 
+// Pragmas apply to the declaration after them. Loop hints need a loop, other
+// pragmas are ignored.
+Declaration* Parser::pragmaDecl() {
+  bool hasHints = false;
+  while (match(1, PRAGMA)) {
+    Token p = advance();
+    if (loopPragma(p.lexeme))
+      hasHints = true;
+    else
+      std::cerr << "line " << p.line << ": Ignoring #pragma " << p.lexeme
+                << std::endl;
+  }
+  if (hasHints && !match(2, FOR, WHILE)) {
+    std::cerr << "line " << peek().line << ": Expect a loop after #pragma"
+              << std::endl;
+    exit(-1);
+  }
+  auto& h = loopHints;
+  if (match(1, WHILE) && (h.interchange || !h.tile.empty() || h.unrollAndJam)) {
+    std::cerr << "line " << peek().line
+              << ": Ignoring #pragma clox on a while loop" << std::endl;
+    h.interchange = false;
+    h.tile.clear();
+    h.unrollAndJam = 0;
+  }
+  return decl();
+}
+
+// Add the hints of `#pragma unroll ...`, `#pragma clang loop ...` or
+// `#pragma clox ...` to loopHints, or return false if text is another pragma.
+bool Parser::loopPragma(const std::string& text) {
+  std::string s = text;
+  for (auto& c : s)
+    if (c == '(' || c == ')' || c == ',') c = ' ';
+  std::stringstream ss(s);
+  std::vector<std::string> words;
+  for (std::string w; ss >> w;) words.push_back(w);
+
+  size_t i = 0;
+  bool clox = !words.empty() && words[0] == "clox";
+  if (clox)
+    i = 1;
+  else if (words.size() >= 2 && words[0] == "clang" && words[1] == "loop")
+    i = 2;
+  if (i == words.size()) return false;
+  auto number = [&words](size_t j) {
+    if (j >= words.size() || words[j].empty() ||
+        words[j].find_first_not_of("0123456789") != std::string::npos)
+      return 0;
+    return std::stoi(words[j]);
+  };
+  auto next = [&words](size_t j) { return j < words.size() ? words[j] : ""; };
+
+  LoopHints h = loopHints;
+  for (; i < words.size(); i++) {
+    auto w = words[i];
+    if (w == "unroll" && number(i + 1)) {
+      h.unrollCount = number(++i);
+    } else if (w == "unroll" && next(i + 1) == "full") {
+      h.unrollFull = true;
+      i++;
+    } else if (w == "unroll" && next(i + 1) == "disable") {
+      h.unrollCount = 1;
+      i++;
+    } else if (w == "unroll") {
+      h.unroll = true;
+      if (next(i + 1) == "enable") i++;
+    } else if (w == "unroll_count" && number(i + 1)) {
+      h.unrollCount = number(++i);
+    } else if (w == "vectorize" && next(i + 1) == "enable") {
+      h.vectorize = true;
+      i++;
+    } else if (w == "vectorize" && next(i + 1) == "disable") {
+      h.vectorizeWidth = 1;
+      i++;
+    } else if (w == "vectorize_width" && number(i + 1)) {
+      h.vectorizeWidth = number(++i);
+    } else if (w == "interleave_count" && number(i + 1)) {
+      h.interleaveCount = number(++i);
+    } else if (clox && w == "interchange") {
+      h.interchange = true;
+    } else if (clox && w == "tile") {
+      h.tile.clear();
+      while (number(i + 1)) h.tile.push_back(number(++i));
+      if (h.tile.empty()) h.tile.push_back(32);
+    } else if (clox && w == "unroll_and_jam" && number(i + 1)) {
+      h.unrollAndJam = number(++i);
+    } else {
+      return false;
+    }
+  }
+  loopHints = h;
+  return true;
+}
+
 Statement* Parser::stmt() {
   Statement* s = nullptr;
   switch (peek().tokenType) {
@@ -107,6 +231,9 @@ Statement* Parser::stmt() {
     case IF:
       s = ifStmt();
       break;
+    case SWITCH:
+      s = switchStmt();
+      break;
     case BREAK:
       s = new BreakStmt();
       advance();
@@ -173,9 +300,46 @@ IfStmt* Parser::ifStmt() {
   return i;
 }
 
+SwitchStmt* Parser::switchStmt() {
+  consume(SWITCH, "Expect `switch`");
+  Expr* e = expression();
+  assert(e);
+  consume(LEFT_BRACE, "Expect `{` after switch condition");
+
+  std::vector<SwitchCase> cases;
+  bool hasDefault = false;
+  while (!match(1, RIGHT_BRACE)) {
+    SwitchCase c;
+    Token t = advance();
+    if (t.tokenType == CASE) {
+      c.label = conditional();
+    } else if (t.tokenType == DEFAULT) {
+      if (hasDefault) {
+        std::cerr << "line " << t.line << ": Multiple default labels in switch"
+                  << std::endl;
+        exit(-1);
+      }
+      hasDefault = true;
+      c.label = nullptr;
+    } else {
+      std::cerr << "line " << t.line << ": Expect `case` or `default` in switch"
+                << std::endl;
+      std::cerr << "\t but got char `" << t.lexeme << "`\n";
+      exit(-1);
+    }
+    consume(COLON, "Expect `:` after case label");
+    while (!match(3, CASE, DEFAULT, RIGHT_BRACE)) c.body.push_back(decl());
+    cases.push_back(c);
+  }
+  consume(RIGHT_BRACE, "Expect `}` at the end of switch");
+  return new SwitchStmt(e, cases);
+}
+
 WhileStmt* Parser::whileStmt() {
   WhileStmt* w = nullptr;
-  consume(WHILE, "Expect `while`");
+  int line = consume(WHILE, "Expect `while`").line;
+  LoopHints hints = loopHints;
+  loopHints = {};
 
   Expr* e = expression();
   assert(e);
@@ -183,7 +347,7 @@ WhileStmt* Parser::whileStmt() {
   Statement* b = stmt();
   assert(b);
 
-  w = new WhileStmt(e, b);
+  w = new WhileStmt(e, b, nullptr, hints, line);
 
   assert(w);
   return w;
@@ -192,7 +356,9 @@ WhileStmt* Parser::whileStmt() {
 // Desugar `for` to `while`
 BlockStmt* Parser::forStmt() {
   BlockStmt* f = nullptr;
-  consume(FOR, "Expect `for`");
+  int line = consume(FOR, "Expect `for`").line;
+  LoopHints hints = loopHints;
+  loopHints = {};
 
   consume(LEFT_PAREN, "Expect `(`");
 
@@ -223,7 +389,8 @@ BlockStmt* Parser::forStmt() {
   Program outer;
 
   outer.push_back(init);
-  outer.push_back(new WhileStmt(condition, b, new ExprStmt(inc)));
+  outer.push_back(
+      new WhileStmt(condition, b, new ExprStmt(inc), hints, line));
 
   f = new BlockStmt(outer);
   return f;
@@ -248,35 +415,91 @@ ExprStmt* Parser::exprStmt() {
 }
 
 TypedVar Parser::typedVar() {
-  Type::Base base;
-  Token t = advance();
-  switch (t.tokenType) {
-    case INT:
-      base = Type::Base::INT;
-      break;
-    case DOUBLE:
-    case FLOAT:
-      base = Type::Base::DOUBLE;
-      break;
-    case CHAR:
-      base = Type::Base::CHAR;
-      break;
-    case BOOL:
-      base = Type::Base::BOOL;
-      break;
-    case VOID:
-      base = Type::Base::VOID;
-      break;
-    default:
-      std::cerr << "Unexpected type " << peek().lexeme << std::endl;
-      exit(-1);
+  Type::Base base = Type::Base::INT;
+  bool isUnsigned = false, hasSign = false, isConst = false;
+  if (match(1, CONST)) {
+    advance();
+    isConst = true;
+  }
+  if (match(2, UNSIGNED, SIGNED)) {
+    isUnsigned = advance().tokenType == UNSIGNED;
+    hasSign = true;
+  }
+
+  int lanes = 0;
+  if (match(1, IDENTIFIER) && vectorType(peek().lexeme, base, lanes)) {
+    advance();
+  } else if (match(1, SHORT)) {  // short, short int
+    advance();
+    base = Type::Base::SHORT;
+    if (match(1, INT)) advance();
+  } else if (match(1, LONG)) {  // long, long long, long int, long long int
+    advance();
+    if (match(1, LONG)) advance();
+    base = Type::Base::LONG;
+    if (match(1, INT)) advance();
+  } else if (!hasSign || match(2, CHAR, INT)) {  // `unsigned` is unsigned int
+    Token t = advance();
+    switch (t.tokenType) {
+      case INT:
+        base = Type::Base::INT;
+        break;
+      case DOUBLE:
+        base = Type::Base::DOUBLE;
+        break;
+      case FLOAT:
+        base = Type::Base::FLOAT;
+        break;
+      case CHAR:
+        base = Type::Base::CHAR;
+        break;
+      case BOOL:
+        base = Type::Base::BOOL;
+        break;
+      case VOID:
+        base = Type::Base::VOID;
+        break;
+      default:
+        std::cerr << "Unexpected type " << peek().lexeme << std::endl;
+        exit(-1);
+    }
+  }
+  bool isPointer = false, isRestrict = false;
+  if (match(1, STAR)) {
+    advance();
+    isPointer = true;
+    if (match(1, RESTRICT)) {
+      advance();
+      isRestrict = true;
+    }
   }
   Token id = consume(IDENTIFIER, "Expect an identifer for variable");
   Type type = {base};
-
+  type.isPointer = isPointer;
+  type.isUnsigned = isUnsigned;
+  type.isConst = isConst;
+  type.isRestrict = isRestrict;
+  type.lanes = lanes;
+
+  if (isPointer && match(1, LEFT_SQUARE)) {
+    std::cerr << "line " << peek().line << ": Arrays of pointers are not "
+              << "supported: `" << id.lexeme << "`" << std::endl;
+    exit(-1);
+  }
   while (match(1, LEFT_SQUARE)) {
     // parse array type
     advance();
+    type.isArray = true;
+    if (type.dims.empty() && match(1, RESTRICT)) {  // a[restrict N]
+      advance();
+      type.isRestrict = true;
+    }
+    if (type.dims.empty() && match(1, RIGHT_SQUARE)) {
+      // the outermost size can be left out where the array is a parameter
+      advance();
+      type.dims.push_back(0);
+      continue;
+    }
     auto num = consume(NUMBER, "Expect a number literal for array size");
 
     int dim = 0;
@@ -289,7 +512,6 @@ TypedVar Parser::typedVar() {
 
     type.dims.push_back(dim);
 
-    type.isArray = true;
     consume(RIGHT_SQUARE, "Expect `]` affter array size");
   }
 
@@ -301,20 +523,42 @@ TypedVar Parser::typedVar() {
   return {type, id};
 }
 
-VarDecl* Parser::varDecl(Type type, Token id) {
+VarDecl* Parser::varDecl(Type type, Token id, bool isStatic) {
+  if (type.isArray && !type.dims[0]) {
+    std::cerr << "line " << id.line << ": Array size missing in declaration of "
+              << id.lexeme << std::endl;
+    exit(-1);
+  }
+  if (type.isRestrict) {
+    std::cerr << "line " << id.line << ": Only a parameter can be restrict"
+              << std::endl;
+    exit(-1);
+  }
   Expr* init = nullptr;
   if (match(1, EQUAL)) {
     advance();
-    init = expression();
+    init = match(1, LEFT_BRACE) ? initList() : expression();
   }
 
-  VarDecl* s = new VarDecl(type, id.lexeme, init);
+  VarDecl* s = new VarDecl(type, id.lexeme, init, isStatic);
   consume(SEMICOLON, "Expect a `;` at the end of a declaration");
 
   assert(s);
   return s;
 }
 
+InitList* Parser::initList() {
+  std::vector<Expr*> elems;
+  consume(LEFT_BRACE, "Expect `{` at the begining of an initializer list");
+  while (!match(1, RIGHT_BRACE)) {
+    elems.push_back(match(1, LEFT_BRACE) ? initList() : expression());
+    if (!match(1, COMMA)) break;
+    advance();
+  }
+  consume(RIGHT_BRACE, "Expect `}` at the end of an initializer list");
+  return new InitList(elems);
+}
+
 Args Parser::args() {
   Args args;
 
@@ -339,7 +583,7 @@ RealArgs Parser::real_args() {
   return args;
 }
 
-FunDecl* Parser::funDecl(Type retType, Token id) {
+FunDecl* Parser::funDecl(Type retType, Token id, bool isStatic) {
   consume(LEFT_PAREN, "Expect `(` as argument list begins");
 
   Args a;
@@ -350,20 +594,24 @@ FunDecl* Parser::funDecl(Type retType, Token id) {
   consume(RIGHT_PAREN, "Expect `)` as argument list ends");
 
   BlockStmt* b = nullptr;
+  auto outer = std::move(addressTaken);
+  addressTaken.clear();
   if (match(1, LEFT_BRACE))
     b = blockStmt();
   else
     consume(SEMICOLON, "Expect `,` after function prototype");
+  std::swap(outer, addressTaken);
 
-  return new FunDecl(id.lexeme, a, b, retType);
+  return new FunDecl(id.lexeme, a, b, retType, isStatic, outer);
 }
 
 Expr* Parser::expression() { return assignment(); }
 
 Expr* Parser::assignment() {
-  Expr* e = equality();
-  if (match(6, EQUAL, SLASH_EQUAL, STAR_EQUAL, PLUS_EQUAL, MINUS_EQUAL,
-            PERCENT_EQUAL)) {
+  Expr* e = conditional();
+  if (match(11, EQUAL, SLASH_EQUAL, STAR_EQUAL, PLUS_EQUAL, MINUS_EQUAL,
+            PERCENT_EQUAL, AMPERSAND_EQUAL, PIPE_EQUAL, CARET_EQUAL,
+            LESS_LESS_EQUAL, GREATER_GREATER_EQUAL)) {
     Token op = advance();
     Expr* v = assignment();
     if (!e->isLval()) {
@@ -372,34 +620,109 @@ Expr* Parser::assignment() {
       exit(-1);
     }
 
-    if (op.tokenType != EQUAL) {  // desuger composition assignment
+    if (op.tokenType != EQUAL) {  // composition assignment
       switch (op.tokenType) {
         case STAR_EQUAL:
-          v = new Binary(e, Token(STAR, "sugar", -1), v);
+          op.tokenType = STAR;
           break;
         case SLASH_EQUAL:
-          v = new Binary(e, Token(SLASH, "sugar", -1), v);
+          op.tokenType = SLASH;
           break;
         case PLUS_EQUAL:
-          v = new Binary(e, Token(PLUS, "sugar", -1), v);
+          op.tokenType = PLUS;
           break;
         case MINUS_EQUAL:
-          v = new Binary(e, Token(MINUS, "sugar", -1), v);
+          op.tokenType = MINUS;
           break;
         case PERCENT_EQUAL:
-          v = new Binary(e, Token(PERCENT, "sugar", -1), v);
+          op.tokenType = PERCENT;
+          break;
+        case AMPERSAND_EQUAL:
+          op.tokenType = AMPERSAND;
+          break;
+        case PIPE_EQUAL:
+          op.tokenType = PIPE;
+          break;
+        case CARET_EQUAL:
+          op.tokenType = CARET;
+          break;
+        case LESS_LESS_EQUAL:
+          op.tokenType = LESS_LESS;
+          break;
+        case GREATER_GREATER_EQUAL:
+          op.tokenType = GREATER_GREATER;
           break;
         default:
           std::cerr << op.lexeme << ". At line  " << op.line << std::endl;
           exit(-1);
       }
-    }
-    op.tokenType = EQUAL;
-    e = new Binary(e, op, v);
+      e = new CompoundAssign(e, op, v);
+    } else
+      e = new Binary(e, op, v);
   }
   return e;
 }
 
+Expr* Parser::conditional() {
+  Expr* cond = logicOr();
+  if (!match(1, QUESTION)) return cond;
+  advance();
+  Expr* thenExpr = expression();
+  consume(COLON, "Expect `:` in conditional expression");
+  Expr* elseExpr = conditional();
+  return new Conditional(cond, thenExpr, elseExpr);
+}
+
+Expr* Parser::logicOr() {
+  Expr* left = logicAnd();
+  while (match(1, OR)) {
+    Token op = advance();
+    Expr* right = logicAnd();
+    left = new Logical(left, op, right);
+  }
+  return left;
+}
+
+Expr* Parser::logicAnd() {
+  Expr* left = bitOr();
+  while (match(1, AND)) {
+    Token op = advance();
+    Expr* right = bitOr();
+    left = new Logical(left, op, right);
+  }
+  return left;
+}
+
+Expr* Parser::bitOr() {
+  Expr* left = bitXor();
+  while (match(1, PIPE)) {
+    Token op = advance();
+    Expr* right = bitXor();
+    left = new Binary(left, op, right);
+  }
+  return left;
+}
+
+Expr* Parser::bitXor() {
+  Expr* left = bitAnd();
+  while (match(1, CARET)) {
+    Token op = advance();
+    Expr* right = bitAnd();
+    left = new Binary(left, op, right);
+  }
+  return left;
+}
+
+Expr* Parser::bitAnd() {
+  Expr* left = equality();
+  while (match(1, AMPERSAND)) {
+    Token op = advance();
+    Expr* right = equality();
+    left = new Binary(left, op, right);
+  }
+  return left;
+}
+
 Expr* Parser::equality() {
   Expr* left = comparsion();
   while (match(2, BANG_EQUAL, EQUAL_EQUAL)) {
@@ -411,8 +734,18 @@ Expr* Parser::equality() {
 }
 
 Expr* Parser::comparsion() {
-  Expr* left = term();
+  Expr* left = shift();
   while (match(4, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL)) {
+    Token op = advance();
+    Expr* right = shift();
+    left = new Binary(left, op, right);
+  }
+  return left;
+}
+
+Expr* Parser::shift() {
+  Expr* left = term();
+  while (match(2, LESS_LESS, GREATER_GREATER)) {
     Token op = advance();
     Expr* right = term();
     left = new Binary(left, op, right);
@@ -442,7 +775,7 @@ Expr* Parser::factor() {
 
 Expr* Parser::unary() {
   std::stack<Token> st;
-  while (match(4, MINUS, BANG, PLUSPLUS, MINUSMINUS)) {
+  while (match(7, MINUS, BANG, TILDE, PLUSPLUS, MINUSMINUS, STAR, AMPERSAND)) {
     Token op = advance();
     st.push(op);
   }
@@ -450,7 +783,13 @@ Expr* Parser::unary() {
   while (!st.empty()) {
     auto op = st.top();
     st.pop();
-    e = new Unary(op, e);
+    // a variable whose address is taken has to stay in memory
+    auto v = dynamic_cast<Variable*>(e);
+    if (op.tokenType == AMPERSAND && v) addressTaken.insert(v->getName());
+    if (op.tokenType == PLUSPLUS || op.tokenType == MINUSMINUS)
+      e = new IncDec(op, e, true);
+    else
+      e = new Unary(op, e);
   }
   return e;
 }
@@ -459,7 +798,7 @@ Expr* Parser::postfix() {
   Expr* p = call();
   while (match(2, PLUSPLUS, MINUSMINUS)) {
     Token op = advance();
-    p = new Postfix(op, p);
+    p = new IncDec(op, p, false);
   }
   return p;
 }
@@ -481,12 +820,13 @@ Expr* Parser::call() {
 Expr* Parser::index() {
   Expr* e = primary();
   std::vector<Expr*> idxs;
+  int line = 0;
   while (match(1, LEFT_SQUARE)) {
-    advance();
+    line = advance().line;
     idxs.push_back(expression());
     consume(RIGHT_SQUARE, "Expect `]` after indexing");
   }
-  if (!idxs.empty()) e = new Index(e, idxs);
+  if (!idxs.empty()) e = new Index(e, idxs, line);
   return e;
 }
 
@@ -494,7 +834,9 @@ Expr* Parser::primary() {
   Expr* prim = nullptr;
   switch (peek().tokenType) {
     case NUMBER:
-      if (peek().lexeme.find('.') != std::string::npos) {
+      if (tolower(peek().lexeme.back()) == 'f') {
+        prim = new Float(advance());
+      } else if (peek().lexeme.find('.') != std::string::npos) {
         prim = new Double(advance());
       } else
         prim = new Integer(advance());
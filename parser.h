@@ -1,10 +1,14 @@
 #ifndef __PARSER_H__
 #define __PARSER_H__
+#include <set>
+
 #include "ast.h"
 #include "scanner.h"
 class Parser {
   std::vector<Token> tokens;
   size_t current;
+  std::set<std::string> addressTaken;  // variables `&` is applied to
+  LoopHints loopHints;                 // for the loop after the pragmas
 
   Token advance();
   Token peek();
@@ -18,9 +22,14 @@ class Parser {
 
   std::vector<Declaration*> program();
 
-  Declaration* decl();       // STMT | VAR_DECL
+  Declaration* decl();       // PRAGMA_DECL | STMT
+                             // | STATIC? (VAR_DECL | FUN_DECL)
+  bool typeName();           // a TYPEDVAR starts here
+  Declaration* pragmaDecl();  // PRAGMA+ DECL
+  bool loopPragma(const std::string& text);  // (CLANG LOOP | CLOX)? HINT+
   Statement* stmt();         // PRINT_STMT | BLOCK_STMT | EXPR_STMT | IF_STMT |
-                             // FOR_STMT | WHILE_STMT | ASSERT_STMT
+                             // FOR_STMT | WHILE_STMT | SWITCH_STMT |
+                             // ASSERT_STMT
   Statement* assertStmt();   // ASSERT EXPR ; // deprecated
   Statement* printStmt();    // PRINT EXPRESSION ; // deprecated
   BlockStmt* blockStmt();    // '{' PROGRAM '}';
@@ -28,23 +37,37 @@ class Parser {
   IfStmt* ifStmt();          // IF EXPRESSION STMT (ELSE STMT)?
   BlockStmt* forStmt();      // FOR '(' VAR_DECL EXPRESSION; EXPRESSION ')' STMT
   WhileStmt* whileStmt();    // WHILE '(' EXPRESSION ')' STMT
+  SwitchStmt* switchStmt();  // SWITCH '(' EXPRESSION ')' '{'
+                             // ((CASE COND | DEFAULT) ':' DECL*)* '}'
   ReturnStmt* returnStmt();  // RETURN EXPR;
-  TypedVar typedVar();       // (INT | DOUBLE | CHAR) '*'? ID ('['SIZE']')*
-  VarDecl* varDecl(Type type, Token id);  // TYPEDVAR
-                                          // (EQUAL EXPRESSION)? ;
-  FunDecl* funDecl(Type type,
-                   Token id);  // TYPEDVAR '(' ARGS? ')' BLOCK?
+  TypedVar typedVar();       // CONST? (UNSIGNED | SIGNED)? (INT | SHORT
+                             // | LONG LONG? | DOUBLE | CHAR | VECTOR)
+                             // ('*' RESTRICT?)?
+                             // ID ('[' RESTRICT? SIZE? ']')? ('['SIZE']')*
+  VarDecl* varDecl(Type type, Token id,
+                   bool isStatic = false);  // TYPEDVAR
+                                            // (EQUAL (EXPRESSION | INIT_LIST))? ;
+  InitList* initList();  // '{' ((EXPR | INIT_LIST) (, ...)* ,?)? '}'
+  FunDecl* funDecl(Type type, Token id,
+                   bool isStatic = false);  // TYPEDVAR '(' ARGS? ')' BLOCK?
   Args args();                 // TYPEDVAR (, TYPEDVAR)*
   RealArgs real_args();        // EXPR (, EXPR)*
 
   Expr* expression();  // ASSIGN
-  Expr* assignment();  // LVAL ('=' | '+=' | '-=' | '*=' | '/=' | '%=') EQUALITY
-                       // | EQUALITY
+  Expr* assignment();  // LVAL ('=' | '+=' | '-=' | '*=' | '/=' | '%=' | '&='
+                       // | '|=' | '^=' | '<<=' | '>>=') ASSIGN | COND
+  Expr* conditional(); // LOGIC_OR ('?' EXPR ':' COND)?
+  Expr* logicOr();     // LOGIC_AND (('||' | OR) LOGIC_AND)*
+  Expr* logicAnd();    // BIT_OR (('&&' | AND) BIT_OR)*
+  Expr* bitOr();       // BIT_XOR ('|' BIT_XOR)*
+  Expr* bitXor();      // BIT_AND ('^' BIT_AND)*
+  Expr* bitAnd();      // EQUALITY ('&' EQUALITY)*
   Expr* equality();    // COMP ('==' | '!=') COMP | COMP
-  Expr* comparsion();  // TERM ('>' | '>=' | '<' | '<=') TERM | TERM
+  Expr* comparsion();  // SHIFT ('>' | '>=' | '<' | '<=') SHIFT | SHIFT
+  Expr* shift();       // TERM (('<<' | '>>') TERM)*
   Expr* term();        // FACTOR (('+' | '-') FACTOR)*
   Expr* factor();      // UNARY (('/' | '*') UNARY)*
-  Expr* unary();       // (! | - | -- | ++)* POSTFIX
+  Expr* unary();       // (! | ~ | - | -- | ++ | * | &)* POSTFIX
   Expr* postfix();     // CALL (++ | --)*
   Expr* call();        // INDEX ('(' ARGS? ')')*
   Expr* index();       // PRIM ('[' EXPR ']')?
@@ -0,0 +1,267 @@
+#include "perf.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "ast.h"
+
+// The variable the update of a loop steps by a constant, and the step. A
+// `while` loop has its update at the end of the body.
+static bool induction(WhileStmt* w, std::string& iv, long long& step) {
+  Declaration* last = w->getUpdate();
+  auto b = dynamic_cast<BlockStmt*>(w->getBody());
+  if (!last && b && !b->getProgram().empty()) last = b->getProgram().back();
+  auto update = dynamic_cast<ExprStmt*>(last);
+  Expr* u = update ? update->getExpr() : nullptr;
+  if (auto x = dynamic_cast<IncDec*>(u)) {
+    auto v = dynamic_cast<Variable*>(x->getTarget());
+    if (!v) return false;
+    iv = v->getName();
+    step = x->getOp().tokenType == PLUSPLUS ? 1 : -1;
+    return true;
+  }
+  if (auto x = dynamic_cast<CompoundAssign*>(u)) {
+    auto v = dynamic_cast<Variable*>(x->getTarget());
+    auto n = dynamic_cast<Integer*>(x->getValue());
+    auto op = x->getOp().tokenType;
+    if (!v || !n || (op != PLUS && op != MINUS)) return false;
+    iv = v->getName();
+    step = op == PLUS ? n->getValue() : -n->getValue();
+    return true;
+  }
+  return false;
+}
+
+// The coefficient of iv in e, if e is affine in it. Other variables are taken
+// to stay the same while iv steps.
+static bool coefficient(Expr* e, const std::string& iv, long long& c) {
+  if (dynamic_cast<Integer*>(e)) {
+    c = 0;
+    return true;
+  }
+  if (auto v = dynamic_cast<Variable*>(e)) {
+    c = v->getName() == iv;
+    return true;
+  }
+  if (auto u = dynamic_cast<Unary*>(e)) {
+    if (u->getOp().tokenType != MINUS ||
+        !coefficient(u->getChild(), iv, c))
+      return false;
+    c = -c;
+    return true;
+  }
+  auto b = dynamic_cast<Binary*>(e);
+  long long l, r;
+  if (!b || !coefficient(b->getLeft(), iv, l) ||
+      !coefficient(b->getRight(), iv, r))
+    return false;
+  auto ln = dynamic_cast<Integer*>(b->getLeft());
+  auto rn = dynamic_cast<Integer*>(b->getRight());
+  switch (b->getOp().tokenType) {
+    case PLUS:
+      c = l + r;
+      return true;
+    case MINUS:
+      c = l - r;
+      return true;
+    case STAR:
+      if (!l && !r)
+        c = 0;
+      else if (ln)
+        c = ln->getValue() * r;
+      else if (rn)
+        c = l * rn->getValue();
+      else
+        return false;
+      return true;
+    default:
+      if (l || r) return false;
+      c = 0;
+      return true;
+  }
+}
+
+void PerfVisitor::visitProgram(Program& prog) {
+  scopes.push_back({});
+  for (auto d : prog) visit(d);
+  scopes.pop_back();
+}
+
+void PerfVisitor::warn(LoopStats& l, int line, const std::string& what) {
+  warnings.push_back("line " + std::to_string(line) + ": warning: in " + fun +
+                     ", loop `" + l.iv + "`: " + what);
+  l.warned = true;
+}
+
+void PerfVisitor::visit(Declaration* d) { d->accept(this); }
+
+void PerfVisitor::visit(ExprStmt* st) { visit(st->getExpr()); }
+
+void PerfVisitor::visit(VarDecl* st) {
+  if (st->getInit()) visit(st->getInit());
+  scopes.back()[st->name()] = st->getType();
+}
+
+void PerfVisitor::visit(FunDecl* st) {
+  if (!st->getBody()) return;
+  fun = st->name();
+  scopes.push_back({});
+  for (auto [type, token] : st->getArgs()) scopes.back()[token.lexeme] = type;
+  visit(st->getBody());
+  scopes.pop_back();
+}
+
+void PerfVisitor::visit(BlockStmt* st) {
+  scopes.push_back({});
+  for (auto d : st->getProgram()) visit(d);
+  scopes.pop_back();
+}
+
+void PerfVisitor::visit(IfStmt* st) {
+  visit(st->getCondition());
+  visit(st->getTrue());
+  if (st->getFalse()) visit(st->getFalse());
+}
+
+// A cache line is 64 bytes. An access moving less than that per iteration
+// touches only as many new bytes; one moving further touches a whole line.
+void PerfVisitor::visit(WhileStmt* st) {
+  visit(st->getCondition());
+  LoopStats l = {"", 0, {}, {}, st->getLine(), false};
+  if (!induction(st, l.iv, l.step)) l.iv.clear();
+  loops.push_back(l);
+  visit(st->getBody());
+  if (st->getUpdate()) visit(st->getUpdate());
+  l = loops.back();
+  loops.pop_back();
+
+  long long touched = 0, data = 0;
+  for (auto [access, stride] : l.stride) {
+    if (!stride) continue;  // the same element each iteration
+    touched += std::min(std::llabs(stride), 64LL);
+    data += l.size[access];
+  }
+  if (touched && l.warned)
+    warnings.push_back("line " + std::to_string(l.line) + ": note: in " + fun +
+                       ", loop `" + l.iv + "` touches about " +
+                       std::to_string(touched) +
+                       " bytes of cache lines per iteration for " +
+                       std::to_string(data) + " bytes of data");
+}
+
+void PerfVisitor::visit(SwitchStmt* st) {
+  visit(st->getCondition());
+  scopes.push_back({});
+  for (auto& c : st->getCases())
+    for (auto d : c.body) visit(d);
+  scopes.pop_back();
+}
+
+void PerfVisitor::visit(BreakStmt* st) {}
+
+void PerfVisitor::visit(ContStmt* st) {}
+
+void PerfVisitor::visit(ReturnStmt* st) {
+  if (st->getExpr()) visit(st->getExpr());
+}
+
+void PerfVisitor::visit(Expr* e) { e->accept(this); }
+
+void PerfVisitor::visit(Literal* e) { e->accept(this); }
+
+void PerfVisitor::visit(Integer* e) {}
+
+void PerfVisitor::visit(Double* e) {}
+
+void PerfVisitor::visit(Float* e) {}
+
+void PerfVisitor::visit(Boolean* e) {}
+
+void PerfVisitor::visit(Char* e) {}
+
+void PerfVisitor::visit(String* e) {}
+
+void PerfVisitor::visit(Binary* e) {
+  visit(e->getLeft());
+  visit(e->getRight());
+}
+
+void PerfVisitor::visit(Logical* e) {
+  visit(e->getLeft());
+  visit(e->getRight());
+}
+
+void PerfVisitor::visit(Conditional* e) {
+  visit(e->getCond());
+  visit(e->getThen());
+  visit(e->getElse());
+}
+
+void PerfVisitor::visit(Unary* e) { visit(e->getChild()); }
+
+void PerfVisitor::visit(CompoundAssign* e) {
+  visit(e->getTarget());
+  visit(e->getValue());
+}
+
+void PerfVisitor::visit(IncDec* e) { visit(e->getTarget()); }
+
+void PerfVisitor::visit(Variable* e) {}
+
+void PerfVisitor::visit(Call* e) {
+  visit(e->getCallee());
+  for (auto a : e->getArgs()) visit(a);
+}
+
+// Arrays are row-major: the last subscript moves through consecutive
+// elements, the one before it through rows, and so on.
+void PerfVisitor::visit(Index* e) {
+  auto idxs = e->getIdxs();
+  for (auto i : idxs) visit(i);
+  auto base = dynamic_cast<Variable*>(e->getBase());
+  if (loops.empty() || loops.back().iv.empty() || !base) return;
+  auto t = lookup(scopes, base->getName());
+  if (!t || !t->isArray || t->dims.size() != idxs.size()) return;
+
+  auto& l = loops.back();
+  auto access = base->getName();
+  for (auto i : idxs) access += "[" + std::string(*i) + "]";
+  if (l.stride.count(access)) return;
+  std::vector<long long> coef(idxs.size());
+  for (size_t p = 0; p < idxs.size(); p++)
+    if (!coefficient(idxs[p], l.iv, coef[p])) return;
+  long long size = sizeOf(t->base), stride = 0, row = 1;
+  for (size_t p = idxs.size(); p-- > 0;) {
+    stride += coef[p] * row;
+    row *= t->dims[p];
+  }
+  stride *= l.step * size;
+  l.stride[access] = stride;
+  l.size[access] = size;
+
+  auto bytes = std::to_string(std::llabs(stride));
+  auto last = idxs.size() - 1;
+  if (!coef[last] && std::any_of(coef.begin(), coef.end(),
+                                 [](long long c) { return c; })) {
+    auto what = access + " walks down the columns of " + base->getName() +
+                ", " + bytes + " bytes apart";
+    for (size_t k = loops.size() - 1; k-- > 0;) {
+      long long c;
+      if (!loops[k].iv.empty() && coefficient(idxs[last], loops[k].iv, c) &&
+          c) {
+        what += "; make loop `" + loops[k].iv + "` the innermost";
+        break;
+      }
+    }
+    warn(l, e->getLine(), what);
+  }
+  auto s = std::llabs(stride);
+  if (s >= 1024 && !(s & (s - 1)))
+    warn(l, e->getLine(), access + " strides " + bytes +
+                " bytes, a power of two, so its elements compete for the "
+                "same cache sets");
+}
+
+void PerfVisitor::visit(InitList* e) {
+  for (auto x : e->getElems()) visit(x);
+}
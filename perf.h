@@ -0,0 +1,67 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "visitor.h"
+
+// The -Wperf diagnostics. For each loop whose update steps a variable by a
+// constant, it works out how far the array elements its body indexes move
+// from one iteration to the next. It warns about row-major arrays walked down
+// their columns and about strides of a large power of two, which map every
+// access to the same cache sets. Next to such a warning, it estimates the
+// bytes of cache lines an iteration of the loop touches.
+class PerfVisitor : public AstVisitor {
+  // a loop being visited and the array elements its body accesses
+  struct LoopStats {
+    std::string iv;  // empty if the loop has no induction variable
+    long long step;
+    std::map<std::string, long long> stride;  // in bytes, by access
+    std::map<std::string, long long> size;    // of the element, by access
+    int line;
+    bool warned;  // about one of the accesses
+  };
+
+  TypeScopes scopes;
+  std::string fun;  // the function being visited
+  std::vector<LoopStats> loops;
+  std::vector<std::string> warnings;
+
+  void warn(LoopStats& l, int line, const std::string& what);
+
+ public:
+  void visitProgram(Program& prog);
+  const std::vector<std::string>& getWarnings() const { return warnings; }
+
+  void visit(Declaration* d) override;
+
+  void visit(ExprStmt* st) override;
+  void visit(VarDecl* d) override;
+  void visit(FunDecl* d) override;
+  void visit(BlockStmt* d) override;
+  void visit(IfStmt* d) override;
+  void visit(WhileStmt* d) override;
+  void visit(SwitchStmt* d) override;
+  void visit(BreakStmt* d) override;
+  void visit(ContStmt* d) override;
+  void visit(ReturnStmt* d) override;
+
+  void visit(Expr* expr) override;
+  void visit(Literal* expr) override;
+  void visit(Integer* expr) override;
+  void visit(Double* expr) override;
+  void visit(Float* expr) override;
+  void visit(Boolean* expr) override;
+  void visit(Char* expr) override;
+  void visit(String* expr) override;
+  void visit(Binary* expr) override;
+  void visit(Logical* expr) override;
+  void visit(Conditional* expr) override;
+  void visit(Unary* expr) override;
+  void visit(CompoundAssign* expr) override;
+  void visit(IncDec* expr) override;
+  void visit(Variable* expr) override;
+  void visit(Call* expr) override;
+  void visit(Index* expr) override;
+  void visit(InitList* expr) override;
+};
@@ -1,5 +1,7 @@
 #include "scanner.h"
 
+#include <set>
+
 std::string Scanner::get_lexeme(TokenType type) {
   if (type == STRING)
     return source.substr(start + 1, current - start - 2);
@@ -90,23 +92,52 @@ void Scanner::number() {
     } else {
       error("broken number expression when lexing");
     }
+    if (peek() == 'f' || peek() == 'F') advance();
+  } else {
+    // integer suffixes: u, l or ll, in either order and either case, with
+    // the two letters of ll in the same case
+    size_t begin = current;
+    while (peek() == 'u' || peek() == 'U' || peek() == 'l' || peek() == 'L')
+      advance();
+    auto suffix = source.substr(begin, current - begin);
+    static const std::set<std::string> valid = {
+        "",    "u",   "U",   "l",   "L",   "ll",  "LL",  "ul",
+        "uL",  "Ul",  "UL",  "lu",  "lU",  "Lu",  "LU",  "ull",
+        "uLL", "Ull", "ULL", "llu", "llU", "LLu", "LLU"};
+    if (!valid.count(suffix))
+      error("invalid suffix `" + suffix + "` on integer constant");
   }
   addToken(NUMBER);
 }
 
 void Scanner::identifierOrKeyword() {
-  while (isalnum(peek())) advance();
+  while (isalnum(peek()) || peek() == '_') advance();
   std::string lexeme = get_lexeme(INVALID);
   TokenType t = string2keyword(lexeme);
   addToken(t == INVALID ? IDENTIFIER : t);
 }
 
+// `#pragma TEXT` becomes one PRAGMA token for the parser to interpret. Other
+// preprocessing directives aren't supported.
+void Scanner::directive() {
+  while (isalpha(peek())) advance();
+  auto name = get_lexeme(INVALID);
+  if (name != "#pragma") error("Unsupported directive " + name);
+  while (peek() == ' ' || peek() == '\t') advance();
+  start = current;
+  while (peek() != '\n' && !eof()) advance();
+  addToken(PRAGMA);
+}
+
 void Scanner::scanToken() {
   char c = advance();
   switch (c) {
     case '"':
       string();
       break;
+    case '#':
+      directive();
+      break;
     case '*':
       addToken(match('=') ? STAR_EQUAL : STAR);
       break;
@@ -145,14 +176,40 @@ void Scanner::scanToken() {
       addToken(match('=') ? EQUAL_EQUAL : EQUAL);
       break;
     case '<':
-      addToken(match('=') ? LESS_EQUAL : LESS);
+      if (match('<'))
+        addToken(match('=') ? LESS_LESS_EQUAL : LESS_LESS);
+      else
+        addToken(match('=') ? LESS_EQUAL : LESS);
       break;
     case '>':
-      addToken(match('=') ? GREATER_EQUAL : GREATER);
+      if (match('>'))
+        addToken(match('=') ? GREATER_GREATER_EQUAL : GREATER_GREATER);
+      else
+        addToken(match('=') ? GREATER_EQUAL : GREATER);
+      break;
+    case '?':
+      addToken(QUESTION);
+      break;
+    case ':':
+      addToken(COLON);
       break;
     case '%':
       addToken(match('=') ? PERCENT_EQUAL : PERCENT);
       break;
+    case '&':
+      addToken(match('&')   ? AND
+               : match('=') ? AMPERSAND_EQUAL
+                            : AMPERSAND);
+      break;
+    case '|':
+      addToken(match('|') ? OR : match('=') ? PIPE_EQUAL : PIPE);
+      break;
+    case '^':
+      addToken(match('=') ? CARET_EQUAL : CARET);
+      break;
+    case '~':
+      addToken(TILDE);
+      break;
     case '(':
       addToken(LEFT_PAREN);
       break;
@@ -191,7 +248,7 @@ void Scanner::scanToken() {
     default:
       if (isdigit(c))
         number();
-      else if (isalpha(c))
+      else if (isalpha(c) || c == '_')
         identifierOrKeyword();
       else {
         error("Unexpected character");
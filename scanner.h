@@ -27,6 +27,7 @@ class Scanner {
   void number();
   void readChar();
   void identifierOrKeyword();
+  void directive();
 
   void addToken(TokenType type);
   void scanToken();
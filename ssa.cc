@@ -0,0 +1,82 @@
+#include "ssa.h"
+
+#include "llvm/IR/CFG.h"
+
+int SSABuilder::declare(const std::string& name, llvm::Type* type) {
+  types.push_back(type);
+  names.push_back(name);
+  return types.size() - 1;
+}
+
+void SSABuilder::write(int var, llvm::BasicBlock* b, llvm::Value* v) {
+  currentDef[b][var] = v;
+}
+
+llvm::Value* SSABuilder::read(int var, llvm::BasicBlock* b) {
+  auto it = currentDef[b].find(var);
+  if (it != currentDef[b].end()) return it->second;
+  return readRecursive(var, b);
+}
+
+llvm::PHINode* SSABuilder::createPhi(int var, llvm::BasicBlock* b) {
+  if (b->empty()) return llvm::PHINode::Create(types[var], 0, names[var], b);
+  return llvm::PHINode::Create(types[var], 0, names[var], &b->front());
+}
+
+llvm::Value* SSABuilder::readRecursive(int var, llvm::BasicBlock* b) {
+  llvm::Value* val = nullptr;
+  if (!sealed.count(b)) {
+    // predecessors are not known yet
+    auto phi = createPhi(var, b);
+    incompletePhis[b][var] = phi;
+    val = phi;
+  } else if (auto pred = b->getSinglePredecessor()) {
+    val = read(var, pred);
+  } else {
+    // break potential cycles with an operandless phi
+    auto phi = createPhi(var, b);
+    write(var, b, phi);
+    val = addPhiOperands(var, phi);
+  }
+  write(var, b, val);
+  return val;
+}
+
+llvm::Value* SSABuilder::addPhiOperands(int var, llvm::PHINode* phi) {
+  auto b = phi->getParent();
+  for (auto pred : llvm::predecessors(b))
+    phi->addIncoming(read(var, pred), pred);
+  return tryRemoveTrivialPhi(phi);
+}
+
+// A phi that merges only itself and one other value is replaced by the value.
+llvm::Value* SSABuilder::tryRemoveTrivialPhi(llvm::PHINode* phi) {
+  llvm::Value* same = nullptr;
+  for (auto& op : phi->incoming_values()) {
+    if (op == same || op == phi) continue;
+    if (same) return phi;  // merges at least two values
+    same = op;
+  }
+  if (!same) same = llvm::UndefValue::get(phi->getType());
+
+  std::vector<llvm::WeakVH> users;
+  for (auto u : phi->users())
+    if (u != phi && llvm::isa<llvm::PHINode>(u)) users.push_back(u);
+
+  phi->replaceAllUsesWith(same);
+  phi->eraseFromParent();
+
+  // removing this phi may make the phis using it trivial, same included
+  llvm::WeakTrackingVH ret = same;
+  for (auto& u : users)
+    if (auto p = llvm::dyn_cast_or_null<llvm::PHINode>(u))
+      tryRemoveTrivialPhi(p);
+  return ret;
+}
+
+void SSABuilder::seal(llvm::BasicBlock* b) {
+  auto phis = incompletePhis[b];
+  incompletePhis.erase(b);
+  for (auto [var, phi] : phis) addPhiOperands(var, phi);
+  sealed.insert(b);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llvm.h"
+#include "llvm/IR/ValueHandle.h"
+
+// On-the-fly SSA construction for the scalar locals of a function, after
+// Braun et al., "Simple and Efficient Construction of Static Single Assignment
+// Form". Variables are read and written per basic block; a block is sealed
+// once all of its predecessors are known, which completes its phi nodes.
+class SSABuilder {
+  std::vector<llvm::Type*> types;
+  std::vector<std::string> names;
+  // WeakTrackingVH follows the replacement of trivial phis
+  std::map<llvm::BasicBlock*, std::map<int, llvm::WeakTrackingVH>> currentDef;
+  std::map<llvm::BasicBlock*, std::map<int, llvm::PHINode*>> incompletePhis;
+  std::set<llvm::BasicBlock*> sealed;
+
+  llvm::PHINode* createPhi(int var, llvm::BasicBlock* b);
+  llvm::Value* readRecursive(int var, llvm::BasicBlock* b);
+  llvm::Value* addPhiOperands(int var, llvm::PHINode* phi);
+  llvm::Value* tryRemoveTrivialPhi(llvm::PHINode* phi);
+
+ public:
+  int declare(const std::string& name, llvm::Type* type);
+  void write(int var, llvm::BasicBlock* b, llvm::Value* v);
+  llvm::Value* read(int var, llvm::BasicBlock* b);
+  void seal(llvm::BasicBlock* b);
+};
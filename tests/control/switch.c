@@ -0,0 +1,82 @@
+int putchar(int c);
+int classify(char c) {
+  switch (c) {
+    case ' ':
+    case '\n':
+      return 0;
+    case '0':
+    case '1':
+    case '2':
+      return 1;
+    case '+':
+      return 2;
+    default:
+      return 3;
+  }
+  return -1;
+}
+int main() {
+  putchar('0' + classify(' '));
+  putchar('0' + classify('1'));
+  putchar('0' + classify('+'));
+  putchar('0' + classify('x'));
+  int state = 0;
+  int steps = 0;
+  while (state != 3) {
+    switch (state) {
+      case 0:
+        state = 2;
+        break;
+      case 1:
+        state = 3;
+        break;
+      case 2:
+        state = 1;
+        steps += 10;
+    }
+    steps++;
+  }
+  putchar('0' + steps - 10);
+  int acc = 0;
+  switch (2) {
+    case 1:
+      acc += 1;
+    case 2:
+      acc += 2;
+    case 1 + 2:
+      acc += 3;
+      break;
+    default:
+      acc += 100;
+  }
+  putchar('0' + acc);
+  for (int i = 0; i < 4; i++) {
+    switch (i) {
+      default:
+        putchar('d');
+        break;
+      case 1:
+        continue;
+    }
+    putchar('0' + i);
+  }
+  // the condition is promoted to int before it meets the labels
+  char c = 44;
+  switch (c) {
+    case 300:
+      putchar('x');
+      break;
+    case 44:
+      putchar('d');
+  }
+  unsigned char u = 255;
+  switch (u) {
+    case -1:
+      putchar('x');
+      break;
+    default:
+      putchar('e');
+  }
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,28 @@
+int putchar(int c);
+// a shift has the type of its left operand, whatever the count's type
+int shr(int m, unsigned long k) { return m >> k; }  // CHECK: ashr i32
+int main() {
+  int a = 12;
+  int b = 10;
+  putchar('0' + (a & b));
+  putchar('0' + (a ^ b));
+  putchar('a' + (a | b));
+  putchar('0' + (~a + 13));
+  putchar('0' + (1 << 3));
+  putchar('0' + (-16 >> 2) + 9);
+  char c = 3;
+  int s = c << 2;
+  putchar('0' + s - 3);
+  bool t = true;
+  putchar('0' + (t | 4));
+  a &= 7;
+  a |= 1;
+  a <<= 1;
+  a >>= 2;
+  a ^= 1;
+  putchar('0' + a);
+  if (shr(-8, 1) == -4) putchar('s');
+  if ((1 | 2 ^ 3 & 1) == 3 && (1 + 1 << 1) == 4) putchar('p');
+  putchar('\n');
+  return 0;
+}
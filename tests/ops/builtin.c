@@ -0,0 +1,37 @@
+int putchar(int c);
+int first(int* p, int n) {
+  if (n <= 0) __builtin_unreachable();
+  return p[0];
+}
+int positive(int x) {
+  if (x > 0) return 1;
+  __builtin_unreachable();
+}
+int main() {
+  int a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  int b[8];
+  __builtin_memcpy(b, a, 8 * 4);
+  if (b[7] == 8 && first(b, 8) == 1 && positive(3)) putchar('c');
+  __builtin_memset(b, 0, 4 * 4);
+  if (b[3] == 0 && b[4] == 5) putchar('s');
+  double r = __builtin_sqrt(2.0);
+  if (r * r > 1.999 && r * r < 2.001 && __builtin_fabsf(-1.5f) == 1.5f)
+    putchar('q');
+  if (__builtin_fma(2, 3, 1) == 7) putchar('f');
+  unsigned x = 240;
+  if (__builtin_popcount(x) == 4 && __builtin_clz(x) == 24 &&
+      __builtin_ctzll(x) == 4 && __builtin_popcountl(-1) == 64)
+    putchar('b');
+  if (__builtin_bswap32(287454020) == 1144201745 &&
+      __builtin_bswap16(4386) == 8721)
+    putchar('w');
+  int s = 0;
+  for (int i = 0; i < 8; i++) {
+    __builtin_prefetch(&a[i] + 4);
+    __builtin_assume(i >= 0);
+    if (__builtin_expect(a[i] > 6, 0)) s += a[i];
+  }
+  if (s == 15) putchar('p');
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,23 @@
+int putchar(int c);
+int main() {
+  int a[4] = {0, 0, 0, 0};
+  int i = 0;
+  a[i++] += 3;
+  a[i++] -= 1;
+  a[++i] = 7;
+  int x = i--;
+  double d = 1;
+  d *= 2.5;
+  d++;
+  int b = 7;
+  b %= 4;
+  putchar('0' + a[0]);
+  if (a[1] == -1) putchar('-');
+  putchar('0' + a[3]);
+  putchar('0' + x);
+  putchar('0' + i);
+  if (d == 3.5) putchar('d');
+  putchar('0' + b);
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,28 @@
+int putchar(int c);
+int clamp(int x, int lo, int hi) { return x < lo ? lo : x > hi ? hi : x; }
+int emit(int c) {
+  putchar(c);
+  return c;
+}
+int main() {
+  putchar('0' + clamp(-4, 0, 9));
+  putchar('0' + clamp(5, 0, 9));
+  putchar('0' + clamp(12, 0, 9));
+  int x = -3;
+  int abs = x < 0 ? -x : x;
+  putchar('0' + abs);
+  double d = x > 0 ? 1 : 0.5;
+  if (d == 0.5) putchar('d');
+  bool b = true;
+  double e = b ? b : 2.5;
+  if (e == 1) putchar('e');
+  int i = 0;
+  int y = i ? emit('n') : emit('y');
+  int a[3] = {4, 5, 6};
+  int z = i < 3 ? a[i] : 0;
+  putchar('0' + z);
+  i == 0 ? i++ : i--;
+  putchar('0' + i);
+  putchar('\n');
+  return 0;
+}
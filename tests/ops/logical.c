@@ -0,0 +1,22 @@
+int putchar(int c);
+bool hit(int x) {
+  putchar('h');
+  return x > 0;
+}
+int main() {
+  int a[4] = {1, 2, 3, 4};
+  int n = 4;
+  int found = 0;
+  for (int i = 0; i < 10 && i < n && a[i] != 3; i++) found++;
+  putchar('0' + found);
+  if (n > 10 && hit(1)) putchar('n');
+  if (n > 1 || hit(1)) putchar('y');
+  if (n > 10 or hit(1)) putchar('y');
+  if (n > 1 and n < 5 and !(n == 2)) putchar('y');
+  bool b = n == 3 || n == 4;
+  if (b) putchar('b');
+  if (0 && hit(1)) putchar('n');
+  if (1 || hit(1)) putchar('c');
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,30 @@
+int putchar(int c);
+int f(int x) {
+  if (x * 1 + 0 > 3 - 1) return 1;
+  return 0;
+  putchar('x');
+}
+int main() {
+  int a = 2 * 3 + 4 / 2 - 7 % 4;
+  double d = 1.5 * 2 - 1;
+  char c = 'a' + 1;
+  int n = -(3 - 5);
+  if (1 < 2) putchar('y');
+  else putchar('n');
+  if (0) putchar('n');
+  while (0) putchar('n');
+  int i = 0;
+  while (1) {
+    if (i++ == 2) break;
+    putchar('w');
+  }
+  if (d != 2.0) putchar('n');
+  putchar('0' + a);
+  putchar(c);
+  putchar('0' + n);
+  putchar('0' + f(3) + f(2));
+  unsigned int u = 1;
+  if ((0 ? u : -1) > 0) putchar('u');  // -1 is converted to unsigned
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Each nest is run once as written and once transformed by a clox pragma; the
+// results must agree. With -Rloop-nest, clox reports on stderr which nests it
+// transformed.
+int putchar(int c);
+int a[9][7];
+int b[9][7];
+int c[7][7];
+int d[7][7];
+
+void fill() {
+  for (int i = 0; i < 9; i++)
+    for (int j = 0; j < 7; j++) {
+      a[i][j] = i * 7 + j;
+      b[i][j] = i * 7 + j;
+    }
+  return;
+}
+
+int same() {
+  for (int i = 0; i < 9; i++)
+    for (int j = 0; j < 7; j++)
+      if (a[i][j] != b[i][j]) return 0;
+  return 1;
+}
+
+void check(char ok) {
+  putchar(same() ? ok : '-');
+  return;
+}
+
+// x = a * a, for the first 7 rows of a
+void product(int x[7][7]) {
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 7; j++) x[i][j] = 0;
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 7; j++)
+      for (int k = 0; k < 7; k++) x[i][j] += a[i][k] * a[k][j];
+  return;
+}
+
+// the same, with the loops reordered to (i, k, j)
+void productInterchanged(int x[restrict 7][7]) {
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 7; j++) x[i][j] = 0;
+#pragma clox interchange
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 7; j++)
+      for (int k = 0; k < 7; k++) x[i][j] += a[i][k] * a[k][j];
+  return;
+}
+
+// called as shift(a), p and a overlap and the loops must stay in order
+void shift(int p[9][7]) {
+#pragma clox interchange
+  for (int i = 1; i < 7; i++)
+    for (int j = 0; j < 8; j++) p[j][i] = a[j + 1][i - 1] + 1;
+  return;
+}
+
+int main() {
+  fill();
+  for (int j = 0; j < 7; j++)
+    for (int i = 0; i < 9; i++) a[i][j] = a[i][j] * 3 + j;
+#pragma clox interchange
+  for (int j = 0; j < 7; j++)
+    for (int i = 0; i < 9; i++) b[i][j] = b[i][j] * 3 + j;
+  check('i');
+
+  fill();
+  for (int i = 1; i < 9; i++)
+    for (int j = 0; j < 6; j++) a[i][j] = a[i - 1][j + 1] + 1;
+#pragma clox tile(4, 2)
+  for (int i = 1; i < 9; i++)
+    for (int j = 0; j < 6; j++) b[i][j] = b[i - 1][j + 1] + 1;
+  check('k');  // not tiled: each row reads the row before, one column right
+
+  fill();
+  for (int i = 0; i < 9; i++)
+    for (int j = 1; j < 7; j++) a[i][j] = a[i][j - 1] + i;
+#pragma clox tile(4, 3)
+  for (int i = 0; i < 9; i++)
+    for (int j = 1; j < 7; j++) b[i][j] = b[i][j - 1] + i;
+  check('t');
+
+  fill();
+  for (int i = 0; i < 9; i++)
+    for (int j = 0; j < 6; j++) a[i][j] = a[i][j + 1] * 2 - i;
+#pragma clox unroll_and_jam(4)
+  for (int i = 0; i < 9; i++)
+    for (int j = 0; j < 6; j++) b[i][j] = b[i][j + 1] * 2 - i;
+  check('u');
+
+  fill();
+  product(c);
+  productInterchanged(d);
+  int equal = 1;
+  for (int i = 0; i < 7; i++)
+    for (int j = 0; j < 7; j++)
+      if (c[i][j] != d[i][j]) equal = 0;
+  putchar(equal ? 'm' : '-');
+
+  fill();
+  shift(a);
+  for (int i = 1; i < 7; i++)
+    for (int j = 0; j < 8; j++) b[j][i] = b[j + 1][i - 1] + 1;
+  check('a');
+  putchar(10);
+  return 0;
+}
@@ -0,0 +1,37 @@
+// Signed int arithmetic is nsw. Each loop here needs that for scalar evolution
+// to compute its trip count (print<scalar-evolution> in opt): upto runs up to
+// n inclusive, and evens and sum step by 2, so with -fwrapv their induction
+// variables could wrap and the counts are unpredictable.
+// CHECK: add nsw i32 %i
+int putchar(int c);
+int upto(int n) {
+  int c = 0;
+  for (int i = 0; i <= n; i++) c++;
+  return c;
+}
+int evens(int n) {
+  int c = 0;
+  for (int i = 0; i < n; i += 2) c++;
+  return c;
+}
+long sum(int a[8], int lo, int hi) {
+  long s = 0;
+  for (int i = lo; i < hi; i += 2) s += a[i];
+  return s;
+}
+int main() {
+  putchar('0' + upto(4));
+  putchar('0' + evens(7));
+  int a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  if (sum(a, 1, 8) == 20) putchar('s');
+  // narrow types are computed in int and may still wrap when stored back
+  short h = 32767;
+  h += 1;
+  char c = -128;
+  c = -c;
+  if (h == -32768 && c == -128) putchar('w');
+  unsigned int u = 0;
+  u--;
+  if (u == 4294967295u) putchar('u');
+  return 0;
+}
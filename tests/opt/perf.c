@@ -0,0 +1,18 @@
+// clox -Wperf warns that the second nest walks m down its columns and that
+// the rows of big are a power of two apart, and notes how many bytes of cache
+// lines those loops touch per iteration. The first nest gets no diagnostics.
+int putchar(int c);
+double m[64][64];
+int big[16][1024];
+int main() {
+  for (int i = 0; i < 64; i++)
+    for (int j = 0; j < 64; j++) m[i][j] = i + j;
+  double s = 0;
+  for (int j = 0; j < 64; j++)
+    for (int i = 0; i < 64; i++) s += m[i][j];
+  for (int i = 0; i < 16; i++) big[i][0] = i;
+  if (s == 258048) putchar('c');
+  putchar('0' + big[7][0]);
+  putchar(10);
+  return 0;
+}
@@ -0,0 +1,17 @@
+// Loop pragmas become llvm.loop metadata on the back edge of the loop.
+int putchar(int c);
+int main() {
+  int a[64];
+  int s = 0;
+#pragma unroll(4)
+  for (int i = 0; i < 64; i++) a[i] = i;
+#pragma clang loop vectorize(enable) vectorize_width(8) interleave_count(2)
+  for (int i = 0; i < 64; i++) s += a[i];
+  int n = 0;
+#pragma unroll full
+  while (n < 3) n++;
+#pragma once
+  if (s == 2016) putchar('p');
+  putchar('0' + n);
+  return 0;
+}
@@ -0,0 +1,44 @@
+int putchar(int c);
+int fib(int n) {
+  int a = 0;
+  int b = 1;
+  while (n > 0) {
+    int t = a + b;
+    a = b;
+    b = t;
+    n--;
+  }
+  return a;
+}
+int collatz(int n) {
+  int steps = 0;
+  for (int m = 0; n != 1; steps++) {
+    if (n % 2 == 0) {
+      n /= 2;
+      continue;
+    } else
+      n = 3 * n + 1;
+  }
+  return steps;
+}
+int main() {
+  int x;
+  int s = 0;
+  for (int i = 0; i < 10; i++) {
+    if (i == 7) break;
+    if (i % 2) continue;
+    s += i;
+  }
+  putchar('0' + s % 10);
+  putchar('0' + fib(10) % 10);
+  putchar('0' + collatz(6));
+  double d = 0;
+  int k = 0;
+  while (k < 4) {
+    d = d + 0.5;
+    k++;
+  }
+  if (d == 2.0) putchar('d');
+  putchar('\n');
+  return 0;
+}
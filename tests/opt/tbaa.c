@@ -0,0 +1,20 @@
+// Loads and stores carry TBAA tags, so the load of scale[0] can be hoisted
+// out of the loop: the stores to b are doubles and can't change an int.
+int putchar(int c);
+void scaleAll(int scale[1], double b[4], int n) {
+  for (int i = 0; i < n; i++) b[i] = b[i] * scale[0];
+  return;
+}
+int main() {
+  int s[1] = {3};
+  double b[4] = {1, 2, 3, 4};
+  scaleAll(s, b, 4);
+  if (b[3] == 12) putchar('t');
+  int x = 0;
+  int* p = &x;
+  *p = 7;
+  unsigned int* q = &x;  // signedness doesn't change the type for aliasing
+  *q += 1;
+  putchar('0' + x);
+  return 0;
+}
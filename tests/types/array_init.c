@@ -0,0 +1,25 @@
+int putchar(int c);
+int main() {
+  int t[4] = {1, 2, 3, 4};
+  // the sizes of the copies are constants of the target's layout
+  // CHECK: @__const.t to i8*), i64 16, i1 false)
+  int z[64] = {0};
+  int m[2][3] = {{1, 2}, {4, 5, 6}};
+  int flat[2][2] = {7, 8, 9};
+  char s[2][4] = {"ab", "cd"};
+  double d[3] = {1.5, 2, -1};
+  int x = 5;
+  int v[3] = {x, 0, x + 1};
+  for (int i = 0; i < 4; i++) putchar('0' + t[i]);
+  for (int i = 0; i < 64; i++) if (z[i]) putchar('!');
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 3; j++) putchar('0' + m[i][j]);
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++) putchar('0' + flat[i][j]);
+  putchar(s[1][1]);
+  if (d[2] < 0) putchar('-');
+  putchar('0' + v[0]);
+  putchar('0' + v[2]);
+  putchar('\n');
+  return 0;
+}
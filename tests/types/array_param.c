@@ -0,0 +1,19 @@
+int putchar(int c);
+int sum(int a[4], int n) {
+  int s = 0;
+  for (int i = 0; i < n; i++) s = s + a[i];
+  return s;
+}
+int trace(int m[3][3]) {
+  return m[0][0] + m[1][1] + m[2][2];
+}
+int main() {
+  int a[4] = {1, 2, 3, 0};
+  int m[3][3] = {{1, 0, 0}, {0, 2, 0}, {0, 0, 4}};
+  char c = 1;
+  putchar('0' + sum(a, 4));
+  putchar('0' + trace(m));
+  putchar('0' + a[c]);
+  putchar('\n');
+  return 0;
+}
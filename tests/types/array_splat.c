@@ -0,0 +1,13 @@
+// Initializers whose bytes are all the same are written with a memset.
+int putchar(int c);
+int main() {
+  char m[8] = {7, 7, 7, 7, 7, 7, 7, 7};
+  int w[4] = {-1, -1, -1, -1};
+  // CHECK: i8 7,
+  // CHECK: i8 -1,
+  // CHECK-NOT: @__const.m
+  // CHECK-NOT: @__const.w
+  if (m[5] == 7 && w[3] == -1) putchar('s');
+  putchar('\n');
+  return 0;
+}
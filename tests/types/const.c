@@ -0,0 +1,20 @@
+int putchar(int c);
+const char digits[16] = "0123456789abcdef";
+const int primes[2][4] = {{2, 3, 5, 7}, {11, 13, 17, 19}};
+const double half = 0.5;
+int hex(int x) {
+  const int shifts[2] = {4, 0};
+  for (int i = 0; i < 2; i++) putchar(digits[(x >> shifts[i]) & 15]);
+  return 0;
+}
+int main() {
+  hex(202);
+  if (primes[1][3] == 19) putchar('p');
+  int sum = 0;
+  for (int i = 0; i < 4; i++) sum += primes[0][i];
+  if (sum == 17) putchar('s');
+  if (half * 4 == 2.0) putchar('h');
+  const int n = 3;
+  putchar('0' + n);
+  return 0;
+}
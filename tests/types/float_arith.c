@@ -0,0 +1,24 @@
+int putchar(int c);
+float half(float x) { return x / 2; }
+int main() {
+  float a[4] = {1.5f, 2, 0.25f, 4};
+  float s = 0;
+  for (int i = 0; i < 4; i++) s += a[i];
+  if (s == 7.75f) putchar('s');
+  float h = half(3);
+  if (h == 1.5) putchar('h');
+  float third = 1.0f / 3;
+  double dthird = 1.0 / 3;
+  if (third != dthird) putchar('p');
+  double widened = third;
+  if (widened == third) putchar('w');
+  float f = 2.5f;
+  f *= 2;
+  f++;
+  if (f == 6) putchar('c');
+  float n = -f;
+  if (n < 0 && !(n == 0)) putchar('n');
+  if (f) putchar('t');
+  putchar('\n');
+  return 0;
+}
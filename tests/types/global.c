@@ -0,0 +1,30 @@
+int putchar(int c);
+int counter;
+int big[1000000];
+char table[4] = {'g', 'l', 'o', 'b'};
+double scale = 2.5;
+int grid[2][3] = {{1, 2, 3}, {4, 5, 6}};
+static int twice(int x) { return 2 * x; }
+int next() {
+  static int n = 10;
+  n++;
+  return n;
+}
+void bump() {
+  counter += 1;
+  return;
+}
+int main() {
+  for (int i = 0; i < 4; i++) putchar(table[i]);
+  bump();
+  bump();
+  putchar('0' + counter);
+  big[999999] = 7;
+  if (big[0] == 0 && big[999999] == 7) putchar('z');
+  if (scale * 2 == 5.0) putchar('s');
+  if (grid[1][2] == 6) putchar('m');
+  next();
+  if (next() == 12) putchar('n');
+  putchar('0' + twice(counter));
+  return 0;
+}
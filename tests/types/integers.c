@@ -0,0 +1,34 @@
+int putchar(int c);
+unsigned int half(unsigned int x) { return x / 2; }
+long square(long x) { return x * x; }
+int main() {
+  unsigned int u = 4000000000u;
+  if (u > 0) putchar('u');
+  if (half(u) == 2000000000) putchar('h');
+  int neg = -1;
+  unsigned int big = neg;
+  if (big >> 28 == 15) putchar('l');
+  if (neg >> 28 == -1) putchar('a');
+  long l = 3000000000;
+  if (l * 2 == 6000000000l) putchar('L');
+  if (square(100000) == 10000000000) putchar('s');
+  short s = 32767;
+  s++;
+  if (s < 0) putchar('w');
+  unsigned char c = 200;
+  int widened = c;
+  if (widened == 200) putchar('z');
+  if (c + c == 400) putchar('p');
+  long long ll = 1ll << 40;
+  if (ll == 1099511627776) putchar('q');
+  unsigned int r = 17u % 5;
+  putchar('0' + r);
+  double d = u;
+  if (d == 4000000000.0) putchar('d');
+  int a[3] = {1, 2, 3};
+  long idx = 2;
+  unsigned int j = 1;
+  putchar('0' + a[idx] + a[j]);
+  putchar('\n');
+  return 0;
+}
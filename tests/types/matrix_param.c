@@ -0,0 +1,22 @@
+int putchar(int c);
+void matmul(int n, double a[][3], double b[3][3], double c[][3]) {
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < 3; j++) {
+      c[i][j] = 0;
+      for (int k = 0; k < 3; k++) c[i][j] += a[i][k] * b[k][j];
+    }
+  return;
+}
+int corner(int t[][2][2]) { return t[1][1][1]; }
+int first(int* row) { return row[0]; }
+int main() {
+  double a[2][3] = {{1, 2, 3}, {4, 5, 6}};
+  double id[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  double c[2][3];
+  matmul(2, a, id, c);
+  if (c[1][2] == 6 && c[0][1] == 2) putchar('m');
+  int t[2][2][2] = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+  putchar('0' + corner(t));
+  putchar('0' + first(t[0][1]));
+  return 0;
+}
@@ -0,0 +1,48 @@
+int putchar(int c);
+void swap(int* a, int* b) {
+  int t = *a;
+  *a = *b;
+  *b = t;
+  return;
+}
+long sum(const int* p, const int* end) {
+  long s = 0;
+  while (p < end) s += *p++;
+  return s;
+}
+int* find(int* p, int n, int x) {
+  for (int i = 0; i < n; i++)
+    if (p[i] == x) return p + i;
+  return 0;
+}
+void fill(char* s, int n, char c) {
+  for (char* e = s + n; s != e; s++) *s = c;
+  return;
+}
+int main() {
+  int x = 1;
+  int y = 2;
+  swap(&x, &y);
+  if (x == 2 && y == 1) putchar('s');
+  int a[6] = {1, 2, 3, 4, 5, 6};
+  if (sum(a, a + 6) == 21) putchar('a');
+  if (sum(a + 2, &a[4]) == 7) putchar('l');
+  int* q = find(a, 6, 5);
+  if (q && q - a == 4 && *q == 5) putchar('f');
+  if (!find(a, 6, 9)) putchar('n');
+  *q += 10;
+  q[1] = 0;
+  if (a[4] == 15 && a[5] == 0) putchar('w');
+  char buf[4] = "abc";
+  fill(buf + 1, 2, 'z');
+  putchar(buf[0]);
+  putchar(buf[2]);
+  unsigned int u = 4000000000u;
+  unsigned int* pu = &u;
+  if (*pu > 0) putchar('u');
+  int* p = &x;
+  p--;
+  p++;
+  if (p == &x && *p == 2) putchar('p');
+  return 0;
+}
@@ -0,0 +1,12 @@
+int putchar(int c);
+void axpy(double a, double x[restrict 4], double* restrict y, int n) {
+  for (int i = 0; i < n; i++) y[i] += a * x[i];
+  return;
+}
+int main() {
+  double x[4] = {1, 2, 3, 4};
+  double y[4] = {1, 1, 1, 1};
+  axpy(2, x, y, 4);
+  if (y[0] == 3 && y[3] == 9) putchar('r');
+  return 0;
+}
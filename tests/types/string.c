@@ -1,6 +1,6 @@
 int puts(char s[1]);
 int main() {
-  char hello[10] = "hello world";
+  char hello[12] = "hello world";
   puts(hello);
   hello[0] = 'a';
   puts(hello);
@@ -0,0 +1,10 @@
+int puts(char s[1]);
+int main() {
+  char s[16] = "hi";
+  puts(s);
+  puts("hi");
+  puts("hi");
+  s[2] = '!';
+  puts(s);
+  return 0;
+}
@@ -0,0 +1,29 @@
+int putchar(int c);
+int4 twice(int4 v) { return v * 2; }
+float4 g = {1, 2, 3};
+int main() {
+  int a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  int4 x = vload4(0, a);
+  int4 y = vload4(1, a);
+  int4 s = x + y;
+  if (s[0] == 6 && s[3] == 12) putchar('a');
+  s = twice(s) - 1;
+  if (__builtin_reduce_add(s) == 68) putchar('s');
+  s[2] = 100;
+  vstore4(s, 1, a);
+  if (a[6] == 100 && a[4] == 11) putchar('i');
+  int4 r = __builtin_shufflevector(x, y, 7, 6, 0, 1);
+  if (r[0] == 8 && r[1] == 7 && r[3] == 2) putchar('h');
+  if (__builtin_reduce_max(r) == 8 && __builtin_reduce_min(-r) == -8)
+    putchar('m');
+  int4 lo = __builtin_elementwise_min(x, 3);
+  if (__builtin_reduce_add(lo) == 9) putchar('e');
+  double4 d = {0.5, 1.5};
+  d = d * 2 + g[1];
+  if (d[0] == 3 && d[1] == 5 && d[3] == 2) putchar('f');
+  unsigned char16 c = 200;
+  c = c + c;
+  if (c[15] == 144) putchar('u');
+  putchar('\n');
+  return 0;
+}
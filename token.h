@@ -21,6 +21,12 @@ enum TokenType {
   LEFT_SQUARE,
   RIGHT_SQUARE,
   PERCENT,
+  AMPERSAND,
+  PIPE,
+  CARET,
+  TILDE,
+  QUESTION,
+  COLON,
 
   // One or two character tokens.
   BANG,
@@ -39,12 +45,22 @@ enum TokenType {
   PLUS_EQUAL,
   MINUS_EQUAL,
   PERCENT_EQUAL,
+  LESS_LESS,
+  GREATER_GREATER,
+  AMPERSAND_EQUAL,
+  PIPE_EQUAL,
+  CARET_EQUAL,
+
+  // Three character tokens.
+  LESS_LESS_EQUAL,
+  GREATER_GREATER_EQUAL,
 
   // Literals.
   IDENTIFIER,
   STRING,
   NUMBER,
   CHARACTER,
+  PRAGMA,  // `#pragma TEXT`, the lexeme is TEXT
 
   // Keywords.
   AND,
@@ -72,6 +88,16 @@ enum TokenType {
   VOID,
   WHILE,
   ASSERT,
+  SWITCH,
+  CASE,
+  DEFAULT,
+  UNSIGNED,
+  SIGNED,
+  SHORT,
+  LONG,
+  STATIC,
+  CONST,
+  RESTRICT,
 
   TEOF
 };
@@ -2,10 +2,49 @@
 
 #include <sstream>
 
+Type Type::element() const {
+  Type t = {base};
+  t.isUnsigned = isUnsigned;
+  t.isConst = isConst;
+  t.lanes = lanes;
+  return t;
+}
+
+Type Type::decay() const {
+  Type t = element();
+  t.isPointer = true;
+  return t;
+}
+
 Type::operator std::string() {
   std::string ret = "variable type";
   std::stringstream ss;
   ss << arraySize;
   if (isArray) ret += " , array of " + ss.str();
+  if (isPointer) ret += " , pointer";
+  if (lanes) ret += " , vector of " + std::to_string(lanes);
   return ret;
 }
+
+const Type* lookup(const TypeScopes& scopes, const std::string& name) {
+  for (auto it = scopes.rbegin(); it != scopes.rend(); it++) {
+    auto t = it->find(name);
+    if (t != it->end()) return &t->second;
+  }
+  return nullptr;
+}
+
+long long sizeOf(Type::Base base) {
+  switch (base) {
+    case Type::Base::SHORT:
+      return 2;
+    case Type::Base::INT:
+    case Type::Base::FLOAT:
+      return 4;
+    case Type::Base::LONG:
+    case Type::Base::DOUBLE:
+      return 8;
+    default:
+      return 1;
+  }
+}
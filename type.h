@@ -1,22 +1,49 @@
 #pragma once
+#include <map>
 #include <string>
 #include <vector>
 
 #include "token.h"
 
 struct Type {
-  enum class Base { VOID, INT, DOUBLE, CHAR, ARRAY, BOOL, FUNCTION } base;
+  enum class Base {
+    VOID,
+    SHORT,
+    INT,
+    LONG,
+    FLOAT,
+    DOUBLE,
+    CHAR,
+    ARRAY,
+    BOOL,
+    FUNCTION
+  } base;
   int arraySize;
   std::vector<int> dims;
   bool isArray;
-  bool isPointer;
+  bool isPointer;  // base, isUnsigned and isConst describe what it points to;
+                   // an array that is a pointer is a parameter
+  bool isUnsigned;
+  bool isConst;
+  bool isRestrict;  // the only way to reach its target, for a parameter
+  int lanes = 0;    // a vector of that many base elements, e.g. 4 for int4
   bool operator==(const Type& rhs) const {
     return base == rhs.base && arraySize == rhs.arraySize &&
-           isArray == rhs.isArray;
+           isArray == rhs.isArray && isPointer == rhs.isPointer &&
+           isUnsigned == rhs.isUnsigned && lanes == rhs.lanes;
   }
+  Type element() const;  // the element of an array or the target of a pointer
+  Type decay() const;    // the pointer an array decays to
   operator std::string();
 };
 
+// The types of the variables in the nested scopes an AST pass is in, the
+// innermost last.
+typedef std::vector<std::map<std::string, Type>> TypeScopes;
+const Type* lookup(const TypeScopes& scopes, const std::string& name);
+
+long long sizeOf(Type::Base base);  // in bytes, for a scalar
+
 struct TypedVar {
   Type type;
   Token id;
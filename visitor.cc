@@ -1,13 +1,17 @@
 #include "visitor.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 
 #include "ast.h"
 #include "llvm.h"
+#include "cmdargs.h"
 #include "log.h"
+#include "ssa.h"
 
 CodeGenVisitor CodeGenVisitor::wrap() {
   return CodeGenVisitor(scope.wrap(), l);
@@ -22,13 +26,20 @@ void CodeGenVisitor::visit(Expr* expr) { expr->accept(this); }
 void CodeGenVisitor::visit(Literal* expr) { expr->accept(this); }
 
 void CodeGenVisitor::visit(Integer* expr) {
-  setValue(llvm::ConstantInt::get(*l.ctx, llvm::APInt(32, expr->value)));
+  setValue(llvm::ConstantInt::get(
+      *l.ctx,
+      llvm::APInt(expr->isLong ? 64 : 32, expr->value, !expr->isUnsigned)));
+  isUnsigned = expr->isUnsigned;
 }
 
 void CodeGenVisitor::visit(Double* expr) {
   setValue(llvm::ConstantFP::get(*l.ctx, llvm::APFloat(expr->value)));
 }
 
+void CodeGenVisitor::visit(Float* expr) {
+  setValue(llvm::ConstantFP::get(l.getFloat(), expr->value));
+}
+
 void CodeGenVisitor::visit(Boolean* expr) {
   setValue(llvm::ConstantInt::get(*l.ctx, llvm::APInt(1, expr->value)));
 }
@@ -46,244 +57,756 @@ void CodeGenVisitor::visit(Binary* expr) {
   rv.visit(expr->right);
   auto rhs = rv.getValue();
 
-  auto op = expr->op.tokenType;
+  if (expr->op.tokenType == EQUAL) {
+    if (!lv.isLval()) abortMsg("cannot assign value to rvalue");
+    rhs = l.implictConvert(rhs, lhs->getType(), rv.isUnsigned);
+    lv.assign(rhs);
+    setTuple(rhs);
+    isUnsigned = lv.isUnsigned;
+    type = lv.getType();
+  } else {
+    auto ret = binaryOp(expr->op, lv.getOperand(), rv.getOperand());
+    setTuple(ret.value);
+    isUnsigned = ret.isUnsigned;
+    // pointer arithmetic keeps the type of the pointer operand
+    if (ret.value->getType()->isPointerTy()) {
+      auto t = lhs->getType()->isPointerTy() ? lv.getType() : rv.getType();
+      type = t.isArray ? t.decay() : t;
+    }
+  }
+}
+
+// Signed overflow is undefined in C, so signed arithmetic in int or wider
+// types can't wrap, unless -fwrapv says otherwise. Narrower types are
+// computed in int and truncated, which may wrap.
+bool CodeGenVisitor::noSignedWrap(llvm::Type* t, bool isUnsigned) {
+  return !options->wrapv() && !isUnsigned && t->isIntegerTy() &&
+         t->getIntegerBitWidth() >= 32;
+}
+
+// Pointer arithmetic and comparisons. p + n and p - n step over n elements,
+// p - q is the number of elements between two pointers of the same type.
+Operand CodeGenVisitor::pointerOp(Token op, Operand a, Operand b) {
+  auto decay = [this](llvm::Value* v) {
+    return v->getType()->isPointerTy() ? l.decayArray(v) : v;
+  };
+  auto lhs = decay(a.value), rhs = decay(b.value);
+  bool lp = lhs->getType()->isPointerTy(), rp = rhs->getType()->isPointerTy();
+  auto offset = [this](llvm::Value* v, bool isUnsigned) {
+    if (!v->getType()->isIntegerTy())
+      abortMsg("pointer offset is not an integer");
+    return l.implictConvert(v, l.getLong(), isUnsigned);
+  };
+
+  llvm::CmpInst::Predicate pred;
+  switch (op.tokenType) {
+    case PLUS:
+      if (lp && rp) abortMsg("cannot add two pointers");
+      if (rp) {  // n + p
+        std::swap(lhs, rhs);
+        std::swap(a, b);
+      }
+      return {l.builder->CreateInBoundsGEP(
+                  lhs->getType()->getPointerElementType(), lhs,
+                  offset(rhs, b.isUnsigned)),
+              false};
+    case MINUS:
+      if (!lp) abortMsg("cannot subtract a pointer from an integer");
+      if (!rp)
+        return {l.builder->CreateInBoundsGEP(
+                    lhs->getType()->getPointerElementType(), lhs,
+                    l.builder->CreateNeg(offset(rhs, b.isUnsigned))),
+                false};
+      if (lhs->getType() != rhs->getType())
+        abortMsg("subtraction of distinct pointer types");
+      return {l.builder->CreatePtrDiff(lhs->getType()->getPointerElementType(),
+                                       lhs, rhs),
+              false};
+    case LESS:
+      pred = llvm::CmpInst::ICMP_ULT;
+      break;
+    case LESS_EQUAL:
+      pred = llvm::CmpInst::ICMP_ULE;
+      break;
+    case GREATER:
+      pred = llvm::CmpInst::ICMP_UGT;
+      break;
+    case GREATER_EQUAL:
+      pred = llvm::CmpInst::ICMP_UGE;
+      break;
+    case EQUAL_EQUAL:
+      pred = llvm::CmpInst::ICMP_EQ;
+      break;
+    case BANG_EQUAL:
+      pred = llvm::CmpInst::ICMP_NE;
+      break;
+    default:
+      abortMsg("cannot apply operator " + op.lexeme + " on pointers");
+  }
+  // a pointer is compared with another one of its type or with 0
+  if (!lp) lhs = l.implictConvert(lhs, rhs->getType());
+  if (!rp) rhs = l.implictConvert(rhs, lhs->getType());
+  if (lhs->getType() != rhs->getType())
+    abortMsg("comparison of distinct pointer types");
+  return {l.builder->CreateICmp(pred, lhs, rhs), false};
+}
+
+// The operands of an operation on vectors, as vectors of one type. A scalar
+// operand is converted to the element type and splat across the lanes.
+std::pair<llvm::Value*, llvm::Value*> CodeGenVisitor::vectorOperands(
+    Operand a, Operand b) {
+  auto vt = (a.value->getType()->isVectorTy() ? a : b).value->getType();
+  auto lanes = [&](Operand o) {
+    if (o.value->getType()->isVectorTy() && o.value->getType() != vt)
+      abortMsg("vector operands of different types");
+    return l.implictConvert(o.value, vt, o.isUnsigned);
+  };
+  return {lanes(a), lanes(b)};
+}
+
+// Element-wise arithmetic on vectors. Unlike scalars, the elements aren't
+// promoted to int first.
+Operand CodeGenVisitor::vectorOp(Token op, Operand a, Operand b) {
+  bool isUnsigned = a.value->getType()->isVectorTy() ? a.isUnsigned
+                                                     : b.isUnsigned;
+  auto [lhs, rhs] = vectorOperands(a, b);
+  auto elem = lhs->getType()->getScalarType();
+  bool fp = elem->isFloatingPointTy();
+  bool nsw = !fp && noSignedWrap(elem, isUnsigned);
+  llvm::Value* ret = nullptr;
+  switch (op.tokenType) {
+    case PLUS:
+      ret = fp ? l.builder->CreateFAdd(lhs, rhs)
+               : l.builder->CreateAdd(lhs, rhs, "", false, nsw);
+      break;
+    case MINUS:
+      ret = fp ? l.builder->CreateFSub(lhs, rhs)
+               : l.builder->CreateSub(lhs, rhs, "", false, nsw);
+      break;
+    case STAR:
+      ret = fp ? l.builder->CreateFMul(lhs, rhs)
+               : l.builder->CreateMul(lhs, rhs, "", false, nsw);
+      break;
+    case SLASH:
+      ret = fp           ? l.builder->CreateFDiv(lhs, rhs)
+            : isUnsigned ? l.builder->CreateUDiv(lhs, rhs)
+                         : l.builder->CreateSDiv(lhs, rhs);
+      break;
+    case PERCENT:
+    case AMPERSAND:
+    case PIPE:
+    case CARET:
+    case LESS_LESS:
+    case GREATER_GREATER:
+      if (fp)
+        abortMsg("cannot apply operator " + op.lexeme + " on non-integer type");
+      if (op.tokenType == PERCENT)
+        ret = isUnsigned ? l.builder->CreateURem(lhs, rhs)
+                         : l.builder->CreateSRem(lhs, rhs);
+      else if (op.tokenType == AMPERSAND)
+        ret = l.builder->CreateAnd(lhs, rhs);
+      else if (op.tokenType == PIPE)
+        ret = l.builder->CreateOr(lhs, rhs);
+      else if (op.tokenType == CARET)
+        ret = l.builder->CreateXor(lhs, rhs);
+      else if (op.tokenType == LESS_LESS)
+        ret = l.builder->CreateShl(lhs, rhs);
+      else
+        ret = isUnsigned ? l.builder->CreateLShr(lhs, rhs)
+                         : l.builder->CreateAShr(lhs, rhs);
+      break;
+    default:
+      abortMsg("cannot apply operator " + op.lexeme + " on vectors");
+  }
+  return {ret, isUnsigned};
+}
+
+// The integer promotion of o: an integer narrower than int becomes an int.
+Operand CodeGenVisitor::promote(Operand o) {
+  auto t = o.value->getType();
+  if (!t->isIntegerTy() || t->getIntegerBitWidth() >= 32) return o;
+  return {l.implictConvert(o.value, l.getInt(), o.isUnsigned), false};
+}
 
-  bool hasDouble = false;
+// Apply the arithmetic or comparison operator op to a and b after the usual
+// arithmetic conversions.
+Operand CodeGenVisitor::binaryOp(Token op, Operand a, Operand b) {
+  auto lhs = a.value, rhs = b.value;
+  bool hasFloat = false;
   bool hasInteger = false;
+  bool unsignedOps = false;  // the converted operands are unsigned
+  bool lhsUnsigned = false;
+  llvm::Value* ret = nullptr;
 
-  if (op != EQUAL) {
-    if (lhs) {
-      hasDouble = lhs->getType()->isDoubleTy() || rhs->getType()->isDoubleTy();
-      hasInteger =
-          lhs->getType()->isIntegerTy() || rhs->getType()->isIntegerTy();
-    }
-    if (hasDouble) {
-      if (!lhs->getType()->isDoubleTy())
-        lhs = l.builder->CreateFPCast(lhs, llvm::Type::getDoubleTy(*l.ctx),
-                                      "casttmp");
-      if (!rhs->getType()->isDoubleTy())
-        rhs = l.builder->CreateFPCast(rhs, llvm::Type::getDoubleTy(*l.ctx),
-                                      "casttmp");
-    } else if (hasInteger) {  // integer upgrade
-      unsigned int maxw = 0;
-      if (lhs->getType()->isIntegerTy())
-        maxw = std::max(maxw, lhs->getType()->getIntegerBitWidth());
-      if (rhs->getType()->isIntegerTy())
-        maxw = std::max(maxw, rhs->getType()->getIntegerBitWidth());
-      auto upgradeType = llvm::IntegerType::get(*l.ctx, maxw);
-      if (lhs->getType() != upgradeType)
-        lhs = l.builder->CreateIntCast(lhs, upgradeType, true, "casttmp");
-      if (rhs->getType() != upgradeType)
-        rhs = l.builder->CreateIntCast(rhs, upgradeType, true, "casttmp");
-    }
+  if (lhs && (lhs->getType()->isPointerTy() || rhs->getType()->isPointerTy()))
+    return pointerOp(op, a, b);
+  if (lhs && (lhs->getType()->isVectorTy() || rhs->getType()->isVectorTy()))
+    return vectorOp(op, a, b);
+  if (lhs) {
+    hasFloat = lhs->getType()->isFloatingPointTy() ||
+               rhs->getType()->isFloatingPointTy();
+    hasInteger = lhs->getType()->isIntegerTy() || rhs->getType()->isIntegerTy();
+  }
+  if (hasFloat) {
+    // float op float and float op integer stay float, as in C
+    auto fpType = lhs->getType()->isDoubleTy() || rhs->getType()->isDoubleTy()
+                      ? l.getDouble()
+                      : l.getFloat();
+    lhs = l.implictConvert(lhs, fpType, a.isUnsigned);
+    rhs = l.implictConvert(rhs, fpType, b.isUnsigned);
+  } else if (hasInteger &&
+             (op.tokenType == LESS_LESS || op.tokenType == GREATER_GREATER)) {
+    // a shift has the promoted type of its left operand alone; the count is
+    // converted to that type and doesn't take part in the usual conversions
+    auto l0 = promote(a);
+    lhs = l0.value;
+    lhsUnsigned = unsignedOps = l0.isUnsigned;
+    if (lhs->getType()->isIntegerTy())
+      rhs = l.implictConvert(rhs, lhs->getType(), b.isUnsigned);
+  } else if (hasInteger) {  // integer upgrade
+    // types narrower than int are promoted to int first, so only an unsigned
+    // operand of the widest type makes the result unsigned
+    unsigned int maxw = 32;
+    if (lhs->getType()->isIntegerTy())
+      maxw = std::max(maxw, lhs->getType()->getIntegerBitWidth());
+    if (rhs->getType()->isIntegerTy())
+      maxw = std::max(maxw, rhs->getType()->getIntegerBitWidth());
+    auto unsignedAt = [](Operand o) {
+      auto t = o.value->getType();
+      return o.isUnsigned && t->isIntegerTy() && t->getIntegerBitWidth() >= 32;
+    };
+    lhsUnsigned = unsignedAt(a);
+    unsignedOps =
+        (lhsUnsigned && lhs->getType()->getIntegerBitWidth() == maxw) ||
+        (unsignedAt(b) && rhs->getType()->getIntegerBitWidth() == maxw);
+    // bools are promoted to 0 or 1
+    auto upgradeType = llvm::IntegerType::get(*l.ctx, maxw);
+    lhs = l.implictConvert(lhs, upgradeType, a.isUnsigned);
+    rhs = l.implictConvert(rhs, upgradeType, b.isUnsigned);
   }
-  switch (op) {
+  bool nsw = hasInteger && noSignedWrap(lhs->getType(), unsignedOps);
+  switch (op.tokenType) {
     case PLUS:
-      if (hasDouble)
-        setTuple(l.builder->CreateFAdd(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFAdd(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateAdd(lhs, rhs));
+        ret = l.builder->CreateAdd(lhs, rhs, "", false, nsw);
       else
         abortMsg("type mismatched");
-      setAddr(nullptr);
       break;
     case MINUS:
-      if (hasDouble)
-        setTuple(l.builder->CreateFSub(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFSub(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateSub(lhs, rhs));
+        ret = l.builder->CreateSub(lhs, rhs, "", false, nsw);
       else
         abortMsg("type mismatched");
       break;
     case STAR:
-      if (hasDouble)
-        setTuple(l.builder->CreateFMul(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFMul(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateMul(lhs, rhs));
+        ret = l.builder->CreateMul(lhs, rhs, "", false, nsw);
       else
         abortMsg("type mismatched");
       break;
     case SLASH:
-      if (hasDouble)
-        setTuple(l.builder->CreateFDiv(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFDiv(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateSDiv(lhs, rhs));
+        ret = unsignedOps ? l.builder->CreateUDiv(lhs, rhs)
+                          : l.builder->CreateSDiv(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case PERCENT:
-      if (hasInteger) {
-        setTuple(l.builder->CreateSRem(lhs, rhs));
+      if (hasInteger && !hasFloat) {
+        ret = unsignedOps ? l.builder->CreateURem(lhs, rhs)
+                          : l.builder->CreateSRem(lhs, rhs);
       } else
         abortMsg("cannot apply operator % on non-integer type");
       break;
+    case AMPERSAND:
+    case PIPE:
+    case CARET:
+    case LESS_LESS:
+    case GREATER_GREATER:
+      if (hasFloat || !hasInteger)
+        abortMsg("cannot apply operator " + op.lexeme + " on non-integer type");
+      if (op.tokenType == AMPERSAND)
+        ret = l.builder->CreateAnd(lhs, rhs);
+      else if (op.tokenType == PIPE)
+        ret = l.builder->CreateOr(lhs, rhs);
+      else if (op.tokenType == CARET)
+        ret = l.builder->CreateXor(lhs, rhs);
+      else if (op.tokenType == LESS_LESS)
+        ret = l.builder->CreateShl(lhs, rhs);
+      else if (lhsUnsigned)  // the signedness of a shift is the left operand's
+        ret = l.builder->CreateLShr(lhs, rhs);
+      else
+        ret = l.builder->CreateAShr(lhs, rhs);
+      break;
     case LESS:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpOLT(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpOLT(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpSLT(lhs, rhs));
+        ret = unsignedOps ? l.builder->CreateICmpULT(lhs, rhs)
+                          : l.builder->CreateICmpSLT(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case LESS_EQUAL:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpOLE(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpOLE(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpSLE(lhs, rhs));
+        ret = unsignedOps ? l.builder->CreateICmpULE(lhs, rhs)
+                          : l.builder->CreateICmpSLE(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case GREATER:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpOGT(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpOGT(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpSGT(lhs, rhs));
+        ret = unsignedOps ? l.builder->CreateICmpUGT(lhs, rhs)
+                          : l.builder->CreateICmpSGT(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case GREATER_EQUAL:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpOGE(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpOGE(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpSGE(lhs, rhs));
+        ret = unsignedOps ? l.builder->CreateICmpUGE(lhs, rhs)
+                          : l.builder->CreateICmpSGE(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case EQUAL_EQUAL:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpOEQ(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpOEQ(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpEQ(lhs, rhs));
+        ret = l.builder->CreateICmpEQ(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
     case BANG_EQUAL:
-      if (hasDouble)
-        setTuple(l.builder->CreateFCmpONE(lhs, rhs));
+      if (hasFloat)
+        ret = l.builder->CreateFCmpUNE(lhs, rhs);
       else if (hasInteger)
-        setTuple(l.builder->CreateICmpNE(lhs, rhs));
+        ret = l.builder->CreateICmpNE(lhs, rhs);
       else
         abortMsg("type mismatched");
       break;
-    case EQUAL:
-      if (lv.getAddr()) {
-        l.builder->CreateStore(rhs, lv.getAddr());
-        setTuple(rhs);
-      } else
-        abortMsg("cannot assign value to rvalue");
-      break;
     default:
-      abortMsg("unexpected binary operator " + expr->op.lexeme);
+      abortMsg("unexpected binary operator " + op.lexeme);
+  }
+  if (ret->getType() == l.getBool()) return {ret, false};  // a comparison
+  bool isShift = op.tokenType == LESS_LESS || op.tokenType == GREATER_GREATER;
+  return {ret, isShift ? lhsUnsigned : unsignedOps};
+}
+
+// Whether e can be evaluated even when it wouldn't be: it has no side effects,
+// can't trap and takes at most `budget` nodes.
+static bool isCheap(Expr* e, int& budget) {
+  if (--budget < 0) return false;
+  if (dynamic_cast<Literal*>(e) && !dynamic_cast<String*>(e)) return true;
+  if (dynamic_cast<Variable*>(e)) return true;
+  if (auto u = dynamic_cast<Unary*>(e))  // a dereference may trap
+    return u->getOp().tokenType != STAR && isCheap(u->getChild(), budget);
+  if (auto b = dynamic_cast<Logical*>(e))
+    return isCheap(b->getLeft(), budget) && isCheap(b->getRight(), budget);
+  if (auto c = dynamic_cast<Conditional*>(e))
+    return isCheap(c->getCond(), budget) && isCheap(c->getThen(), budget) &&
+           isCheap(c->getElse(), budget);
+  if (auto b = dynamic_cast<Binary*>(e)) {
+    auto op = b->getOp().tokenType;
+    if (op == EQUAL || op == SLASH || op == PERCENT) return false;
+    return isCheap(b->getLeft(), budget) && isCheap(b->getRight(), budget);
+  }
+  return false;
+}
+
+void CodeGenVisitor::visit(Logical* expr) {
+  bool isAnd = expr->op.tokenType == AND;
+
+  CodeGenVisitor lv(scope, l);
+  lv.visit(expr->left);
+  auto lhs = l.convertToTruthy(lv.getValue());
+
+  int budget = 8;
+  if (isCheap(expr->right, budget)) {
+    // evaluate both sides and pick without branching
+    CodeGenVisitor rv(scope, l);
+    rv.visit(expr->right);
+    auto rhs = l.convertToTruthy(rv.getValue());
+    if (isAnd)
+      setTuple(l.builder->CreateSelect(lhs, rhs, l.builder->getFalse()));
+    else
+      setTuple(l.builder->CreateSelect(lhs, l.builder->getTrue(), rhs));
+    return;
+  }
+
+  auto f = l.builder->GetInsertBlock()->getParent();
+  auto lhsB = l.builder->GetInsertBlock();
+  auto rhsB = llvm::BasicBlock::Create(*l.ctx, isAnd ? "and.rhs" : "or.rhs", f);
+  auto endB = llvm::BasicBlock::Create(*l.ctx, isAnd ? "and.end" : "or.end");
+
+  if (isAnd)
+    l.builder->CreateCondBr(lhs, rhsB, endB);
+  else
+    l.builder->CreateCondBr(lhs, endB, rhsB);
+  seal(rhsB);
+
+  l.builder->SetInsertPoint(rhsB);
+  CodeGenVisitor rv(scope, l);
+  rv.visit(expr->right);
+  auto rhs = l.convertToTruthy(rv.getValue());
+  rhsB = l.builder->GetInsertBlock();
+  l.builder->CreateBr(endB);
+
+  f->getBasicBlockList().push_back(endB);
+  l.builder->SetInsertPoint(endB);
+  seal(endB);
+  auto phi = l.builder->CreatePHI(l.getBool(), 2);
+  phi->addIncoming(l.builder->getInt1(!isAnd), lhsB);
+  phi->addIncoming(rhs, rhsB);
+  setTuple(phi);
+}
+
+// The type both arms of a conditional are converted to. An integer result is
+// unsigned if an arm of its width is.
+static llvm::Type* commonType(llvmWrapper& l, Operand x, Operand y,
+                              bool& isUnsigned) {
+  auto a = x.value->getType(), b = y.value->getType();
+  isUnsigned = false;
+  if (a->isDoubleTy() || b->isDoubleTy()) return l.getDouble();
+  if (a->isFloatTy() || b->isFloatTy()) return l.getFloat();
+  if (a->isIntegerTy() && b->isIntegerTy()) {
+    auto wa = a->getIntegerBitWidth(), wb = b->getIntegerBitWidth();
+    isUnsigned = wa == wb ? x.isUnsigned || y.isUnsigned
+                          : (wa > wb ? x : y).isUnsigned;
+    return wa > wb ? a : b;
+  }
+  if (a == b) return a;
+  abortMsg("incompatible operand types in conditional expression");
+  return nullptr;
+}
+
+void CodeGenVisitor::visit(Conditional* expr) {
+  CodeGenVisitor cv(scope, l);
+  cv.visit(expr->cond);
+  auto cond = l.convertToTruthy(cv.getValue());
+
+  int budget = 8;
+  if (isCheap(expr->thenExpr, budget) && isCheap(expr->elseExpr, budget)) {
+    // both arms are side-effect free and can't trap, pick without branching
+    CodeGenVisitor tv(scope, l), ev(scope, l);
+    tv.visit(expr->thenExpr);
+    ev.visit(expr->elseExpr);
+    bool isUnsignedArms;
+    auto t = commonType(l, tv.getOperand(), ev.getOperand(), isUnsignedArms);
+    auto thenV = l.implictConvert(tv.getValue(), t, tv.isUnsigned);
+    auto elseV = l.implictConvert(ev.getValue(), t, ev.isUnsigned);
+    setTuple(l.builder->CreateSelect(cond, thenV, elseV));
+    isUnsigned = isUnsignedArms;
+    type = tv.getType();
+    return;
   }
+
+  auto f = l.builder->GetInsertBlock()->getParent();
+  auto thenB = llvm::BasicBlock::Create(*l.ctx, "cond.true", f);
+  auto elseB = llvm::BasicBlock::Create(*l.ctx, "cond.false");
+  auto endB = llvm::BasicBlock::Create(*l.ctx, "cond.end");
+
+  l.builder->CreateCondBr(cond, thenB, elseB);
+  seal(thenB);
+  seal(elseB);
+
+  l.builder->SetInsertPoint(thenB);
+  CodeGenVisitor tv(scope, l);
+  tv.visit(expr->thenExpr);
+  thenB = l.builder->GetInsertBlock();
+
+  f->getBasicBlockList().push_back(elseB);
+  l.builder->SetInsertPoint(elseB);
+  CodeGenVisitor ev(scope, l);
+  ev.visit(expr->elseExpr);
+  elseB = l.builder->GetInsertBlock();
+
+  // the arms are converted once both types are known
+  bool isUnsignedArms;
+  auto t = commonType(l, tv.getOperand(), ev.getOperand(), isUnsignedArms);
+  l.builder->SetInsertPoint(thenB);
+  auto thenV = l.implictConvert(tv.getValue(), t, tv.isUnsigned);
+  l.builder->CreateBr(endB);
+  l.builder->SetInsertPoint(elseB);
+  auto elseV = l.implictConvert(ev.getValue(), t, ev.isUnsigned);
+  l.builder->CreateBr(endB);
+
+  f->getBasicBlockList().push_back(endB);
+  l.builder->SetInsertPoint(endB);
+  seal(endB);
+  auto phi = l.builder->CreatePHI(t, 2);
+  phi->addIncoming(thenV, thenB);
+  phi->addIncoming(elseV, elseB);
+  setTuple(phi);
+  isUnsigned = isUnsignedArms;
+  type = tv.getType();
 }
 
 void CodeGenVisitor::visit(Unary* expr) {
   visit(expr->child);
   auto op = expr->op.tokenType;
-  if (op == BANG) {
+  if ((op == STAR || op == AMPERSAND) && type.isArray) {
+    // an array decays to a pointer to its first element
+    value = l.decayArray(value);
+    type = type.decay();
+    setAddr(nullptr);
+    if (op == AMPERSAND) return;
+  }
+  if (op == STAR) {
+    // the target of a pointer is an lvalue
+    if (!type.isPointer) abortMsg("cannot dereference a non-pointer");
+    type = type.element();
+    setAddr(value);
+    auto load = l.builder->CreateLoad(l.getBaseType(type), addr);
+    l.setTBAA(load, type);
+    value = load;
+    readOnly = type.isConst;
+    isUnsigned = type.isUnsigned;
+    return;
+  } else if (op == AMPERSAND) {
+    if (!addr) abortMsg("cannot take the address of an rvalue");
+    if (type.isPointer) abortMsg("pointers to pointers are not supported");
+    setTuple(addr);
+    type = type.decay();
+    return;
+  } else if (op == BANG) {
     value = l.convertToTruthy(value);
     value = l.builder->CreateNot(value);
+    isUnsigned = false;
   } else if (op == MINUS) {
-    value = l.builder->CreateNeg(value);
+    if (value->getType()->isFPOrFPVectorTy())
+      value = l.builder->CreateFNeg(value);
+    else
+      value = l.builder->CreateNeg(
+          value, "", false,
+          noSignedWrap(value->getType()->getScalarType(), isUnsigned));
+  } else if (op == TILDE) {
+    if (!value->getType()->isIntOrIntVectorTy())
+      abortMsg("cannot apply operator ~ on non-integer type");
+    value = l.builder->CreateNot(value);
   } else {
-    if (!addr)
-      abortMsg("cannot apply operator " + expr->op.lexeme + " to lvalue");
-    if (!value->getType()->isIntegerTy())
-      abortMsg("cant apply " + expr->op.lexeme + "to non integer");
-    int width = value->getType()->getIntegerBitWidth();
-    auto con = llvm::Constant::getIntegerValue(value->getType(),
-                                               llvm::APInt(width, 1, true));
-    switch (op) {
-      case MINUSMINUS:
-        value = l.builder->CreateSub(value, con);
-        break;
-      case PLUSPLUS:
-        value = l.builder->CreateAdd(value, con);
-        break;
-      default:
-        break;
-    }
-    l.builder->CreateStore(value, addr);
+    abortMsg("unexpected unary operator " + expr->op.lexeme);
   }
+  setAddr(nullptr);
 }
 
-void CodeGenVisitor::visit(Postfix* expr) {
-  visit(expr->child);
-  if (!value->getType()->isIntegerTy())
-    abortMsg("cant apply " + expr->op.lexeme + "to non integer");
-  int width = value->getType()->getIntegerBitWidth();
-  auto con = llvm::Constant::getIntegerValue(value->getType(),
-                                             llvm::APInt(width, 1, true));
-  llvm::Value* ret = nullptr;
+// The address of the target is computed once, then loaded, modified and
+// stored back, so side effects in e.g. an index expression happen only once.
+void CodeGenVisitor::visit(CompoundAssign* expr) {
+  CodeGenVisitor tv(scope, l);
+  tv.visit(expr->target);
+  if (!tv.isLval()) abortMsg("cannot assign value to rvalue");
+
+  CodeGenVisitor vv(scope, l);
+  vv.visit(expr->value);
+
+  auto old = tv.getValue();
+  auto ret = binaryOp(expr->op, tv.getOperand(), vv.getOperand());
+  auto val = l.implictConvert(ret.value, old->getType(), ret.isUnsigned);
+  tv.assign(val);
+  setTuple(val);
+  isUnsigned = tv.isUnsigned;
+  type = tv.getType();
+}
+
+void CodeGenVisitor::visit(IncDec* expr) {
+  CodeGenVisitor tv(scope, l);
+  tv.visit(expr->target);
+  if (!tv.isLval())
+    abortMsg("cannot apply operator " + expr->op.lexeme + " to rvalue");
+
+  auto old = tv.getValue();
+  auto t = old->getType();
+  bool isFloat = t->isFloatingPointTy();
+  if (t->isPointerTy()) {  // a pointer steps over one element
+    auto step = expr->op.tokenType == PLUSPLUS ? 1 : -1;
+    auto val = l.builder->CreateInBoundsGEP(t->getPointerElementType(), old,
+                                            l.builder->getInt64(step));
+    tv.assign(val);
+    setTuple(expr->prefix ? val : old);
+    type = tv.getType();
+    return;
+  }
+  if (!t->isIntegerTy() && !isFloat)
+    abortMsg("cant apply " + expr->op.lexeme + " to non arithmetic type");
+  llvm::Value* one = isFloat ? llvm::ConstantFP::get(t, 1.0)
+                             : llvm::ConstantInt::get(t, 1);
+  bool nsw = noSignedWrap(t, tv.isUnsigned);
+  llvm::Value* val = nullptr;
   switch (expr->op.tokenType) {
     case PLUSPLUS:
-      ret = l.builder->CreateAdd(value, con);
+      val = isFloat ? l.builder->CreateFAdd(old, one)
+                    : l.builder->CreateAdd(old, one, "", false, nsw);
       break;
     case MINUSMINUS:
-      ret = l.builder->CreateSub(value, con);
+      val = isFloat ? l.builder->CreateFSub(old, one)
+                    : l.builder->CreateSub(old, one, "", false, nsw);
       break;
     default:
-      abortMsg("unimplemented postfix operator " + expr->op.lexeme);
+      abortMsg("unimplemented operator " + expr->op.lexeme);
       break;
   }
-  l.builder->CreateStore(ret, addr);
+  tv.assign(val);
+  setTuple(expr->prefix ? val : old);
+  isUnsigned = tv.isUnsigned;
 }
 
 void CodeGenVisitor::visit(String* expr) {
-  auto s = expr->value;
-  int size = s.size() + 1;
-  addr = nullptr;
-  value = l.createEntryBlockAlloca(
-      scope.getTrace().llvmFun, l.getChar(), s,
-      llvm::Constant::getIntegerValue(l.getInt(), llvm::APInt(32, size)));
-  for (int i = 0; i <= s.size(); i++) {
-    char c = 0;
-    if (i < s.size()) c = s[i];
-    auto ptr = l.builder->CreateConstGEP1_32(value, i, "idx");
-    l.builder->CreateStore(
-        llvm::Constant::getIntegerValue(l.getChar(), llvm::APInt(8, c)), ptr);
-  }
+  auto data = llvm::ConstantDataArray::getString(*l.ctx, expr->value);
+  auto str = l.getConstantData(data);
+  setAddr(nullptr);
+  value = l.builder->CreateConstInBoundsGEP2_32(str->getValueType(), str, 0, 0,
+                                                "str");
 }
 
 void CodeGenVisitor::visit(Variable* expr) {
   auto r = scope.get(expr->name);
-  if (r.type.isArray) {
-    addr = nullptr;  // an array is a lvalue
-    value = r.addr;  // value of an array is its base address
+  if (r.addr && llvm::isa<llvm::Function>(r.addr)) {
+    abortMsg("function " + expr->name + " used as a value");
+  } else if (r.type.isArray) {
+    setAddr(nullptr);  // an array is a lvalue
+    value = r.addr;    // value of an array is its base address
+  } else if (r.ssa >= 0) {
+    setAddr(nullptr);
+    ssaVar = r.ssa;
+    value = scope.getTrace().ssa->read(r.ssa, l.builder->GetInsertBlock());
   } else {
-    addr = r.addr;
-    value = l.builder->CreateLoad(l.getType(r.type), r.addr, r.id.c_str());
+    setAddr(r.addr);
+    auto gv = llvm::dyn_cast<llvm::GlobalVariable>(r.addr);
+    if (gv && gv->isConstant()) {
+      value = gv->getInitializer();  // a const global is its initializer
+    } else {
+      // only file-scope initializers are generated outside a block
+      if (!l.builder->GetInsertBlock())
+        abortMsg(expr->name + " is read in a constant initializer");
+      auto load =
+          l.builder->CreateLoad(l.getType(r.type), r.addr, r.id.c_str());
+      l.setTBAA(load, r.type);
+      value = load;
+    }
   }
+  readOnly = r.type.isConst && !r.type.isPointer;
   type = r.type;
+  isUnsigned = r.type.isUnsigned;
+}
+
+// The element of the constant array c at the constant indices idxs, the first
+// of which steps over the array itself; nullptr if it is out of bounds or an
+// index isn't constant.
+static llvm::Constant* constantElement(llvm::Constant* c,
+                                       const std::vector<llvm::Value*>& idxs) {
+  for (size_t i = 1; i < idxs.size() && c; i++) {
+    auto idx = llvm::dyn_cast<llvm::ConstantInt>(idxs[i]);
+    auto at = llvm::dyn_cast<llvm::ArrayType>(c->getType());
+    if (!idx || !at || idx->getValue().uge(at->getNumElements()))
+      return nullptr;
+    c = c->getAggregateElement(idx->getZExtValue());
+  }
+  return c;
 }
 
 void CodeGenVisitor::visit(Index* expr) {
   CodeGenVisitor ev(scope, l);
   ev.visit(expr->base);
   Type type = ev.getType();
-  CodeGenVisitor ev2(scope, l);
-  llvm::Value* offset =
-      llvm::Constant::getIntegerValue(l.getInt(), llvm::APInt(32, 0));
-  if (expr->idxs.size() != type.dims.size()) abortMsg("invalid array index");
-  for (size_t i = 0; i < expr->idxs.size(); i++) {
-    int factor = 1;
-    for (size_t j = i + 1; j < type.dims.size(); j++) factor *= type.dims[j];
-
-    ev2.visit(expr->idxs[i]);
-    auto factorValue =
-        llvm::Constant::getIntegerValue(l.getInt(), llvm::APInt(32, factor));
-    auto part_offset = l.builder->CreateMul(ev2.getValue(), factorValue);
-    offset = l.builder->CreateAdd(offset, part_offset);
+  if (ev.getValue()->getType()->isVectorTy()) {  // a lane of a vector
+    if (expr->idxs.size() != 1) abortMsg("invalid vector index");
+    CodeGenVisitor iv(scope, l);
+    iv.visit(expr->idxs[0]);
+    auto idx = l.implictConvert(iv.getValue(), l.getLong(), iv.isUnsigned);
+    auto vec = ev.getValue();
+    value = l.builder->CreateExtractElement(vec, idx);
+    if (ev.getAddr()) {
+      setAddr(l.builder->CreateInBoundsGEP(
+          vec->getType(), ev.getAddr(), {l.builder->getInt64(0), idx}));
+      readOnly = ev.readOnly;
+    } else {
+      setAddr(nullptr);
+    }
+    isUnsigned = ev.isUnsigned;
+    this->type = type.element();
+    this->type.lanes = 0;
+    return;
   }
+  // a pointer is indexed like a one-dimensional array
+  size_t rank = type.isArray ? type.dims.size() : type.isPointer;
+  if (expr->idxs.size() > rank || !rank) abortMsg("invalid array index");
+
   auto base = ev.getValue();
-  auto ptr = l.builder->CreateGEP(base, offset);
-  value = l.builder->CreateLoad(ptr);
-  addr = static_cast<llvm::AllocaInst*>(ptr);
+  auto pointee = base->getType()->getPointerElementType();
+  size_t depth = 0;
+  for (auto t = pointee; t->isArrayTy(); t = t->getArrayElementType()) depth++;
+  std::vector<llvm::Value*> idxs;
+  // the array itself is indexed through its address; an array parameter or a
+  // pointer already points to the first row or element. Either way the GEP
+  // keeps the dimensions, so strides are constants of the type.
+  if (depth == rank) idxs.push_back(l.builder->getInt64(0));
+  CodeGenVisitor ev2(scope, l);
+  // indices are 64-bit, so arrays can be larger than 2 GB
+  for (auto i : expr->idxs) {
+    ev2.visit(i);
+    idxs.push_back(
+        l.implictConvert(ev2.getValue(), l.getLong(), ev2.isUnsigned));
+  }
+  auto ptr = l.builder->CreateInBoundsGEP(pointee, base, idxs);
+  if (expr->idxs.size() < rank) {  // a row of an array is an array itself
+    type.dims.erase(type.dims.begin(), type.dims.begin() + expr->idxs.size());
+    type.arraySize = 1;
+    for (auto x : type.dims) type.arraySize *= x;
+    type.isPointer = false;
+    setTuple(ptr);
+    this->type = type;
+    return;
+  }
+  // a const table never changes: a constant index reads its initializer, and
+  // other loads from it are invariant
+  auto table = llvm::dyn_cast<llvm::GlobalVariable>(base);
+  if (table && !table->isConstant()) table = nullptr;
+  auto c = table && depth == rank
+               ? constantElement(table->getInitializer(), idxs)
+               : nullptr;
+  if (c) {
+    value = c;
+  } else {
+    if (!l.builder->GetInsertBlock())
+      abortMsg("array element is read in a constant initializer");
+    auto load = l.builder->CreateLoad(l.getBaseType(type), ptr);
+    l.setTBAA(load, type.element());
+    if (table)
+      load->setMetadata(llvm::LLVMContext::MD_invariant_load,
+                        llvm::MDNode::get(*l.ctx, {}));
+    value = load;
+  }
+  setAddr(ptr);
+  readOnly = type.isConst;
+  isUnsigned = type.isUnsigned;
+  this->type = type.element();
 }
+
+void CodeGenVisitor::visit(InitList* expr) {
+  abortMsg("initializer list is only allowed in array declarations");
+}
+
 void CodeGenVisitor::visit(Call* expr) {
   // Look up the name in the global module table.
   auto funcName = dynamic_cast<Variable*>(expr->callee)->name;
   llvm::Function* fun = l.mod->getFunction(funcName);
+  if (!fun &&
+      (intrinsic(funcName, expr->args) || builtin(funcName, expr->args)))
+    return;
   if (!fun) abortMsg("Unknown function " + funcName + " referenced");
 
   // If argument mismatch error.
@@ -298,13 +821,8 @@ void CodeGenVisitor::visit(Call* expr) {
   for (auto a : expr->args) {
     auto protoArg = fun->getArg(i++);
     v.visit(a);
-    auto val = v.getValue();
-    if (protoArg->getType()->isPointerTy()) {
-      // FIXME: a hack. see all array type in function prototype as ptrs
-    } else {
-      val = l.implictConvert(val, protoArg->getType());
-    }
-    args.push_back(val);
+    args.push_back(
+        l.implictConvert(v.getValue(), protoArg->getType(), v.isUnsigned));
     if (!args.back()) {
       value = nullptr;
       abortMsg("failed to generate for arguments");
@@ -312,6 +830,327 @@ void CodeGenVisitor::visit(Call* expr) {
   }
 
   value = l.builder->CreateCall(fun, args);
+  // unless a local shadows it, the function's record has its return type
+  auto r = scope.get(funcName);
+  isUnsigned = r.addr == fun && r.type.isUnsigned;
+  if (r.addr == fun) type = r.type;
+}
+
+// Generate a call to one of the __builtin_ functions of GCC and clang that
+// have an LLVM intrinsic, so the backend emits an instruction for it and the
+// optimizer knows what it does instead of seeing a library call:
+//   memcpy, memset        llvm.memcpy, llvm.memset; return the destination
+//   sqrt, fabs, fma       on double, or float with an f suffix
+//   popcount, clz, ctz    on unsigned int, or long with an l or ll suffix
+//   bswap16/32/64
+//   prefetch(p, rw = 0, locality = 3)
+//   expect(e, c), assume(c), unreachable()
+// Returns false if name isn't one of them.
+bool CodeGenVisitor::intrinsic(const std::string& name,
+                               const std::vector<Expr*>& args) {
+  using Base = Type::Base;
+  static const std::map<std::string, size_t> arities = {
+      {"memcpy", 3},      {"memset", 3},
+      {"sqrt", 1},        {"sqrtf", 1},
+      {"fabs", 1},        {"fabsf", 1},
+      {"fma", 3},         {"fmaf", 3},
+      {"popcount", 1},    {"popcountl", 1}, {"popcountll", 1},
+      {"clz", 1},         {"clzl", 1},      {"clzll", 1},
+      {"ctz", 1},         {"ctzl", 1},      {"ctzll", 1},
+      {"bswap16", 1},     {"bswap32", 1},   {"bswap64", 1},
+      {"prefetch", 3},    {"expect", 2},    {"assume", 1},
+      {"unreachable", 0}};
+  const std::string prefix = "__builtin_";
+  if (name.rfind(prefix, 0) != 0) return false;
+  auto fn = name.substr(prefix.size());
+  auto it = arities.find(fn);
+  if (it == arities.end()) return false;
+
+  std::vector<Operand> ops;
+  std::vector<Type> types;
+  for (auto a : args) {
+    CodeGenVisitor v(scope, l);
+    v.visit(a);
+    ops.push_back(v.getOperand());
+    types.push_back(v.getType());
+  }
+  // prefetch has defaults for all but its first argument
+  if (ops.size() != it->second && !(fn == "prefetch" && ops.size() >= 1 &&
+                                    ops.size() <= it->second))
+    abortMsg("Incorrect # arguments passed to " + name);
+  // argument i converted to t
+  auto arg = [&](size_t i, Type t) {
+    return l.implictConvert(ops[i].value, l.getType(t), ops[i].isUnsigned);
+  };
+  auto pointer = [&](size_t i) {
+    if (!types[i].isArray && !types[i].isPointer)
+      abortMsg(name + " expects a pointer argument");
+    return l.decayArray(ops[i].value);
+  };
+  // a constant argument from 0 to max
+  auto constant = [&](size_t i, int dflt, int max) -> llvm::Value* {
+    if (i >= ops.size()) return l.builder->getInt32(dflt);
+    auto c = llvm::dyn_cast<llvm::ConstantInt>(ops[i].value);
+    if (!c) abortMsg(name + " expects a constant argument");
+    if (c->isNegative() || c->getValue().ugt(max))
+      abortMsg(name + " argument " + std::to_string(i + 1) +
+               " must be between 0 and " + std::to_string(max));
+    return l.builder->getInt32(c->getZExtValue());
+  };
+  // an integer operand type picked by the l and ll suffixes
+  auto integer = [&](const std::string& stem) {
+    Type t = {fn == stem ? Base::INT : Base::LONG};
+    t.isUnsigned = true;
+    return t;
+  };
+
+  Type t = {Base::VOID};
+  llvm::Value* ret = nullptr;
+  if (fn == "memcpy" || fn == "memset") {
+    auto dst = pointer(0);
+    auto align = l.mod->getDataLayout().getABITypeAlign(
+        dst->getType()->getPointerElementType());
+    Type size = {Base::LONG};
+    size.isUnsigned = true;
+    if (fn == "memcpy") {
+      auto src = pointer(1);
+      auto srcAlign = l.mod->getDataLayout().getABITypeAlign(
+          src->getType()->getPointerElementType());
+      l.builder->CreateMemCpy(dst, align, src, srcAlign, arg(2, size));
+    } else {
+      l.builder->CreateMemSet(dst, arg(1, {Base::CHAR}), arg(2, size), align);
+    }
+    ret = dst;
+    t = types[0].isPointer ? types[0] : types[0].decay();
+  } else if (fn.rfind("sqrt", 0) == 0 || fn.rfind("fabs", 0) == 0 ||
+             fn.rfind("fma", 0) == 0) {
+    t = {fn.back() == 'f' ? Base::FLOAT : Base::DOUBLE};
+    if (fn.rfind("fma", 0) == 0)
+      ret = l.builder->CreateIntrinsic(llvm::Intrinsic::fma, {l.getType(t)},
+                                       {arg(0, t), arg(1, t), arg(2, t)});
+    else
+      ret = l.builder->CreateUnaryIntrinsic(
+          fn[0] == 's' ? llvm::Intrinsic::sqrt : llvm::Intrinsic::fabs,
+          arg(0, t));
+  } else if (fn.rfind("popcount", 0) == 0) {
+    ret = l.builder->CreateUnaryIntrinsic(llvm::Intrinsic::ctpop,
+                                          arg(0, integer("popcount")));
+  } else if (fn.rfind("clz", 0) == 0 || fn.rfind("ctz", 0) == 0) {
+    // like GCC's, the result for 0 is undefined
+    auto id = fn[1] == 'l' ? llvm::Intrinsic::ctlz : llvm::Intrinsic::cttz;
+    auto v = arg(0, integer(fn.substr(0, 3)));
+    ret = l.builder->CreateBinaryIntrinsic(id, v, l.builder->getTrue());
+  } else if (fn.rfind("bswap", 0) == 0) {
+    t = {fn == "bswap16" ? Base::SHORT
+         : fn == "bswap32" ? Base::INT
+                           : Base::LONG};
+    t.isUnsigned = true;
+    ret = l.builder->CreateUnaryIntrinsic(llvm::Intrinsic::bswap, arg(0, t));
+  } else if (fn == "prefetch") {
+    auto p = pointer(0);
+    // the last operand selects the data cache
+    ret = l.builder->CreateIntrinsic(
+        llvm::Intrinsic::prefetch, {p->getType()},
+        {p, constant(1, 0, 1), constant(2, 3, 3), l.builder->getInt32(1)});
+  } else if (fn == "expect") {
+    t = {Base::LONG};
+    ret = l.builder->CreateIntrinsic(llvm::Intrinsic::expect, {l.getType(t)},
+                                     {arg(0, t), arg(1, t)});
+  } else if (fn == "assume") {
+    ret = l.builder->CreateAssumption(l.convertToTruthy(ops[0].value));
+  } else {  // unreachable
+    ret = l.builder->CreateUnreachable();
+    // whatever follows is dead code, emitted into a block nothing jumps to
+    auto dead = llvm::BasicBlock::Create(
+        *l.ctx, "dead", l.builder->GetInsertBlock()->getParent());
+    l.builder->SetInsertPoint(dead);
+    seal(dead);
+  }
+  // the bit counts are ints whatever they count in
+  if (fn.rfind("popcount", 0) == 0 || fn.rfind("clz", 0) == 0 ||
+      fn.rfind("ctz", 0) == 0) {
+    t = {Base::INT};
+    ret = l.builder->CreateIntCast(ret, l.getInt(), false);
+  }
+  setTuple(ret);
+  isUnsigned = t.isUnsigned;
+  type = t;
+  return true;
+}
+
+// Generate a call to one of the builtin functions, which map straight to IR:
+//   vloadN(offset, p)        the vector of the N elements at p + offset * N
+//   vstoreN(v, offset, p)    store them
+//   __builtin_shufflevector(a, b, i...)  lanes i... of a and b concatenated
+//   __builtin_reduce_OP(v)   OP (add, mul, and, or, xor, min or max) of the
+//                            lanes of v
+//   __builtin_elementwise_min(a, b), __builtin_elementwise_max(a, b)
+// Returns false if name isn't a builtin.
+bool CodeGenVisitor::builtin(const std::string& name,
+                             const std::vector<Expr*>& args) {
+  std::string op;
+  size_t lanes = 0;
+  for (std::string fn : {"vload", "vstore"})
+    if (name.rfind(fn, 0) == 0) {
+      auto n = name.substr(fn.size());
+      if (n == "2" || n == "4" || n == "8" || n == "16") op = fn;
+      if (!op.empty()) lanes = std::stoi(n);
+    }
+  const std::string reduce = "__builtin_reduce_";
+  const std::string elementwise = "__builtin_elementwise_";
+  if (name.rfind(reduce, 0) == 0 || name.rfind(elementwise, 0) == 0 ||
+      name == "__builtin_shufflevector")
+    op = name;
+  if (op.empty()) return false;
+
+  std::vector<Operand> ops;
+  std::vector<Type> types;
+  for (auto a : args) {
+    CodeGenVisitor v(scope, l);
+    v.visit(a);
+    ops.push_back(v.getOperand());
+    types.push_back(v.getType());
+  }
+  auto arity = [&](size_t n) {
+    if (ops.size() != n) abortMsg("Incorrect # arguments passed to " + name);
+  };
+  auto vector = [&](size_t i) {
+    if (!ops[i].value->getType()->isVectorTy())
+      abortMsg(name + " expects a vector argument");
+    return llvm::cast<llvm::FixedVectorType>(ops[i].value->getType());
+  };
+
+  if (op == "vload" || op == "vstore") {
+    size_t p = op == "vload" ? 1 : 2;
+    arity(p + 1);
+    if (!types[p].isArray && !types[p].isPointer)
+      abortMsg(name + " expects a pointer argument");
+    Type t = types[p].element();
+    if (t.lanes) abortMsg(name + " on a pointer to vectors");
+    auto ptr = l.decayArray(ops[p].value);
+    auto elem = ptr->getType()->getPointerElementType();
+    auto vt = llvm::FixedVectorType::get(elem, lanes);
+    auto offset =
+        l.implictConvert(ops[p - 1].value, l.getLong(), ops[p - 1].isUnsigned);
+    offset = l.builder->CreateMul(offset, l.builder->getInt64(lanes));
+    ptr = l.builder->CreateInBoundsGEP(elem, ptr, offset);
+    ptr = l.builder->CreateBitCast(ptr, vt->getPointerTo());
+    // only the alignment of the elements is known
+    auto align = l.mod->getDataLayout().getABITypeAlign(elem);
+    t.lanes = lanes;
+    if (op == "vload") {
+      auto load = l.builder->CreateAlignedLoad(vt, ptr, align);
+      l.setTBAA(load, t);
+      setTuple(load);
+    } else {
+      auto v = l.implictConvert(ops[0].value, vt, ops[0].isUnsigned);
+      l.setTBAA(l.builder->CreateAlignedStore(v, ptr, align), t);
+      setTuple(v);
+    }
+    isUnsigned = t.isUnsigned;
+    type = t;
+    return true;
+  }
+
+  if (op == "__builtin_shufflevector") {
+    if (ops.size() < 3) arity(3);
+    auto vt = vector(0);
+    if (vector(1) != vt) abortMsg(name + " on vectors of different types");
+    std::vector<int> mask;
+    for (size_t i = 2; i < ops.size(); i++) {
+      auto c = llvm::dyn_cast<llvm::ConstantInt>(ops[i].value);
+      if (!c || c->getSExtValue() < 0 ||
+          c->getSExtValue() >= 2 * vt->getNumElements())
+        abortMsg(name + " index is not a constant lane");
+      mask.push_back(c->getSExtValue());
+    }
+    setTuple(l.builder->CreateShuffleVector(ops[0].value, ops[1].value, mask));
+    isUnsigned = ops[0].isUnsigned;
+    type = types[0];
+    type.lanes = mask.size();
+    return true;
+  }
+
+  if (op.rfind(reduce, 0) == 0) {
+    arity(1);
+    auto v = ops[0].value;
+    auto elem = vector(0)->getElementType();
+    bool fp = elem->isFloatingPointTy(), sign = !ops[0].isUnsigned;
+    auto what = op.substr(reduce.size());
+    llvm::Value* ret = nullptr;
+    if (what == "add")
+      ret = fp ? l.builder->CreateFAddReduce(llvm::ConstantFP::get(elem, -0.0),
+                                             v)
+               : l.builder->CreateAddReduce(v);
+    else if (what == "mul")
+      ret = fp ? l.builder->CreateFMulReduce(llvm::ConstantFP::get(elem, 1.0),
+                                             v)
+               : l.builder->CreateMulReduce(v);
+    else if (what == "min")
+      ret = fp ? l.builder->CreateFPMinReduce(v)
+               : l.builder->CreateIntMinReduce(v, sign);
+    else if (what == "max")
+      ret = fp ? l.builder->CreateFPMaxReduce(v)
+               : l.builder->CreateIntMaxReduce(v, sign);
+    else if (fp && (what == "and" || what == "or" || what == "xor"))
+      abortMsg(name + " on non-integer type");
+    else if (what == "and")
+      ret = l.builder->CreateAndReduce(v);
+    else if (what == "or")
+      ret = l.builder->CreateOrReduce(v);
+    else if (what == "xor")
+      ret = l.builder->CreateXorReduce(v);
+    else
+      abortMsg("Unknown function " + name + " referenced");
+    setTuple(ret);
+    isUnsigned = ops[0].isUnsigned;
+    type = types[0];
+    type.lanes = 0;
+    return true;
+  }
+
+  // __builtin_elementwise_
+  arity(2);
+  auto what = op.substr(elementwise.size());
+  if (what != "min" && what != "max")
+    abortMsg("Unknown function " + name + " referenced");
+  size_t v = ops[0].value->getType()->isVectorTy() ? 0 : 1;
+  auto elem = vector(v)->getElementType();
+  auto [a, b] = vectorOperands(ops[0], ops[1]);
+  bool min = what == "min";
+  llvm::Intrinsic::ID id;
+  if (elem->isFloatingPointTy())
+    id = min ? llvm::Intrinsic::minnum : llvm::Intrinsic::maxnum;
+  else if (ops[v].isUnsigned)
+    id = min ? llvm::Intrinsic::umin : llvm::Intrinsic::umax;
+  else
+    id = min ? llvm::Intrinsic::smin : llvm::Intrinsic::smax;
+  setTuple(l.builder->CreateBinaryIntrinsic(id, a, b));
+  isUnsigned = ops[v].isUnsigned;
+  type = types[v];
+  return true;
+}
+
+// Store v into the lvalue named by the last expression.
+void CodeGenVisitor::assign(llvm::Value* v) {
+  if (readOnly) abortMsg("cannot assign to a const object");
+  if (ssaVar >= 0)
+    scope.getTrace().ssa->write(ssaVar, l.builder->GetInsertBlock(), v);
+  else
+    l.setTBAA(l.builder->CreateStore(v, addr), type);
+}
+
+// Whether a variable of type t is kept in SSA values instead of memory.
+bool CodeGenVisitor::promotable(const Type& t, const std::string& name) {
+  auto trace = scope.getTrace();
+  // lanes of a vector are stored through their addresses
+  return trace.ssa && !t.isArray && !t.lanes &&
+         !trace.fun->addressTaken.count(name);
+}
+
+// All predecessors of b have been emitted.
+void CodeGenVisitor::seal(llvm::BasicBlock* b) {
+  if (auto ssa = scope.getTrace().ssa) ssa->seal(b);
 }
 
 void CodeGenVisitor::visit(Declaration* d) { d->accept(this); }
@@ -321,39 +1160,218 @@ void CodeGenVisitor::visit(ExprStmt* st) {
   v.visit(st->expr);
 }
 
+// Whether an initializer consists of literals only, which folding has made of
+// every constant expression.
+static bool isLiteralInit(Expr* init) {
+  if (auto list = dynamic_cast<InitList*>(init)) {
+    for (auto e : list->getElems())
+      if (!isLiteralInit(e)) return false;
+    return true;
+  }
+  return dynamic_cast<Literal*>(init) != nullptr;
+}
+
 void CodeGenVisitor::visit(VarDecl* st) {
-  auto type = l.getType(st->type);
+  auto varType = st->type;
+
+  // file-scope and static variables live in globals, not on the stack, and
+  // so do const arrays initialized by literals, which are never rebuilt
+  bool table = varType.isConst && varType.isArray &&
+               (!st->init || isLiteralInit(st->init));
+  if (!scope.getTrace().llvmFun || st->isStatic || table) {
+    defineGlobal(st, varType);
+    return;
+  }
 
-  llvm::Value* size = nullptr;
+  auto type = l.getType(varType);
+  if (promotable(varType, st->identifier)) {
+    auto ssa = scope.getTrace().ssa;
+    int var = ssa->declare(st->identifier, type);
+    llvm::Value* val = llvm::UndefValue::get(type);
+    if (st->init) val = initValue(varType, st->init);
+    ssa->write(var, l.builder->GetInsertBlock(), val);
+    scope.define(st->identifier, {st->identifier, st->type, nullptr, var});
+    return;
+  }
 
-  if (st->type.isArray) {
-    size = llvm::Constant::getIntegerValue(l.getInt(),
-                                           llvm::APInt(32, st->type.arraySize));
-    type = type->getArrayElementType();
+  auto addr =
+      l.createEntryBlockAlloca(scope.getTrace().llvmFun, type, st->identifier);
+  if (st->init && varType.isArray) {
+    initArray(varType, addr, st->init);
+  } else if (st->init) {
+    auto val = initValue(varType, st->init);
+    l.setTBAA(l.builder->CreateStore(val, addr), varType);
   }
+  scope.define(st->identifier, {st->identifier, st->type, addr});
+}
 
-  llvm::AllocaInst* addr = nullptr;
-  if (st->init && st->type.isArray) {
-    auto baseType = st->type.base;
-    if (baseType == Type::Base::CHAR && dynamic_cast<String*>(st->init)) {
+// The value of the initializer of a scalar or vector of type t. A vector
+// takes a list of its first elements, the rest are zero.
+llvm::Value* CodeGenVisitor::initValue(const Type& t, Expr* init) {
+  auto type = l.getType(t);
+  auto list = dynamic_cast<InitList*>(init);
+  if (list && type->isVectorTy()) {
+    auto vt = llvm::cast<llvm::FixedVectorType>(type);
+    if (list->elems.size() > vt->getNumElements())
+      abortMsg("excess elements in vector initializer");
+    llvm::Value* v = llvm::Constant::getNullValue(vt);
+    for (size_t i = 0; i < list->elems.size(); i++) {
       CodeGenVisitor ev(scope, l);
-      ev.visit(st->init);
-      addr = (llvm::AllocaInst*)ev.getValue();
-    } else {
-      abortMsg("array doesn't not support this kind of initializers");
+      ev.visit(list->elems[i]);
+      auto e = l.implictConvert(ev.getValue(), vt->getElementType(),
+                                ev.isUnsigned);
+      v = l.builder->CreateInsertElement(v, e, i);
+    }
+    return v;
+  }
+  CodeGenVisitor ev(scope, l);
+  ev.visit(init);
+  return l.implictConvert(ev.getValue(), type, ev.isUnsigned);
+}
+
+// Rebuild the nested array constant of type t from its elements in row-major
+// order, starting at flat[pos].
+static llvm::Constant* nestConstant(llvm::Type* t,
+                                    const std::vector<llvm::Constant*>& flat,
+                                    size_t& pos) {
+  auto at = llvm::dyn_cast<llvm::ArrayType>(t);
+  if (!at) return flat[pos++];
+  std::vector<llvm::Constant*> elems;
+  for (uint64_t i = 0; i < at->getNumElements(); i++)
+    elems.push_back(nestConstant(at->getElementType(), flat, pos));
+  return llvm::ConstantArray::get(at, elems);
+}
+
+// Define a variable with static storage as a global. Its initializer must be
+// constant; a zero initializer puts it in .bss, anything else in .data, or in
+// .rodata if it's const. Only non-static file-scope variables are visible to
+// other objects.
+void CodeGenVisitor::defineGlobal(VarDecl* st, const Type& t) {
+  auto fun = scope.getTrace().llvmFun;
+  if (!fun) l.builder->ClearInsertionPoint();  // no code outside functions
+
+  auto type = l.getType(t);
+  auto notConstant = [&st]() {
+    abortMsg("initializer of " + st->identifier +
+             " is not a compile-time constant");
+  };
+  llvm::Constant* init = llvm::Constant::getNullValue(type);
+  if (st->init && t.isArray) {
+    auto elemType = l.getBaseType(t);
+    std::vector<llvm::Constant*> consts;
+    for (auto v : arrayInit(t, st->init)) {
+      if (v && !llvm::isa<llvm::Constant>(v)) notConstant();
+      consts.push_back(v ? llvm::cast<llvm::Constant>(v)
+                         : llvm::Constant::getNullValue(elemType));
     }
+    size_t pos = 0;
+    init = nestConstant(type, consts, pos);
+  } else if (st->init) {
+    init = llvm::dyn_cast<llvm::Constant>(initValue(t, st->init));
+    if (!init) notConstant();
+  }
+
+  // a static local is named after its function, as clang does
+  auto name =
+      fun ? fun->getName().str() + "." + st->identifier : st->identifier;
+  auto linkage = fun || st->isStatic ? llvm::GlobalValue::InternalLinkage
+                                     : llvm::GlobalValue::ExternalLinkage;
+  auto gv =
+      new llvm::GlobalVariable(*l.mod, type, t.isConst, linkage, init, name);
+  if (fun && t.isConst)
+    gv->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  scope.define(st->identifier, {st->identifier, t, gv});
+}
+
+// The elements of an array of type t initialized by a string literal or a
+// brace initializer, in row-major order. Elements without an initializer are
+// nullptr.
+std::vector<llvm::Value*> CodeGenVisitor::arrayInit(const Type& t, Expr* init) {
+  std::vector<llvm::Value*> flat(t.arraySize, nullptr);
+  if (auto list = dynamic_cast<InitList*>(init)) {
+    flattenInit(list, t, 0, 0, t.arraySize, flat);
+  } else if (t.base == Type::Base::CHAR && t.dims.size() == 1 &&
+             dynamic_cast<String*>(init)) {
+    auto s = dynamic_cast<String*>(init)->getValue();
+    // the terminating null is dropped when only it doesn't fit, as in C
+    if (s.size() > flat.size()) abortMsg("initializer-string is too long");
+    for (size_t i = 0; i < s.size(); i++) flat[i] = l.builder->getInt8(s[i]);
   } else {
-    addr = l.createEntryBlockAlloca(scope.getTrace().llvmFun, type,
-                                    st->identifier, size);
-    if (st->init) {
-      CodeGenVisitor ev(scope, l);
-      ev.visit(st->init);
-      auto val = ev.getValue();
-      val = l.implictConvert(val, type);
-      l.builder->CreateStore(val, addr);
+    abortMsg("array doesn't not support this kind of initializers");
+  }
+  return flat;
+}
+
+// Initialize the array at addr from a string literal or a brace initializer.
+// The constant part is written with one memset or one memcpy from a constant
+// global; elements that are not constant are stored one by one afterwards.
+void CodeGenVisitor::initArray(Type t, llvm::AllocaInst* addr, Expr* init) {
+  auto elemType = l.getBaseType(t);
+  auto arrayType = llvm::ArrayType::get(elemType, t.arraySize);
+  auto flat = arrayInit(t, init);
+
+  std::vector<llvm::Constant*> consts;
+  for (auto v : flat) {
+    auto c = llvm::dyn_cast_or_null<llvm::Constant>(v);
+    consts.push_back(c ? c : llvm::Constant::getNullValue(elemType));
+  }
+  auto data = llvm::ConstantArray::get(arrayType, consts);
+  auto bytes = l.builder->getInt64(
+      l.mod->getDataLayout().getTypeAllocSize(arrayType));
+
+  if (auto byte = l.getSplatByte(data)) {
+    l.builder->CreateMemSet(addr, byte, bytes, addr->getAlign());
+  } else {
+    auto src = l.getConstantData(data, "__const." + addr->getName().str());
+    l.builder->CreateMemCpy(addr, addr->getAlign(), src, src->getAlign(),
+                            bytes);
+  }
+
+  llvm::Value* elems = nullptr;
+  for (size_t i = 0; i < flat.size(); i++) {
+    if (!flat[i] || llvm::isa<llvm::Constant>(flat[i])) continue;
+    if (!elems) elems = l.decayArray(addr);
+    auto ptr = l.builder->CreateConstInBoundsGEP1_32(elemType, elems, i);
+    l.setTBAA(l.builder->CreateStore(flat[i], ptr), t.element());
+  }
+}
+
+// Flatten the brace initializer of the sub-array [begin, end) at dimension
+// `level` of t into flat, in row-major order. A nested list or string starts
+// at the next sub-array boundary; scalars fill the elements one by one.
+void CodeGenVisitor::flattenInit(InitList* list, const Type& t, size_t level,
+                                 size_t begin, size_t end,
+                                 std::vector<llvm::Value*>& flat) {
+  size_t stride = 1;
+  for (size_t j = level + 1; j < t.dims.size(); j++) stride *= t.dims[j];
+
+  auto elemType = l.getBaseType(t);
+  size_t pos = begin;
+  for (auto e : list->elems) {
+    auto sub = dynamic_cast<InitList*>(e);
+    auto str = dynamic_cast<String*>(e);
+    bool row = t.base == Type::Base::CHAR && level + 2 == t.dims.size();
+    if (sub || (str && row)) {
+      if (level + 1 >= t.dims.size())
+        abortMsg("braces around scalar initializer");
+      pos = begin + (pos - begin + stride - 1) / stride * stride;
+      if (pos >= end) abortMsg("excess elements in array initializer");
+      if (sub) {
+        flattenInit(sub, t, level + 1, pos, pos + stride, flat);
+      } else {
+        auto s = str->getValue();
+        if (s.size() > stride) abortMsg("initializer-string is too long");
+        for (size_t i = 0; i < s.size(); i++)
+          flat[pos + i] = l.builder->getInt8(s[i]);
+      }
+      pos += stride;
+    } else {
+      if (pos >= end) abortMsg("excess elements in array initializer");
+      CodeGenVisitor v(scope, l);
+      v.visit(e);
+      flat[pos++] = l.implictConvert(v.getValue(), elemType, v.isUnsigned);
     }
   }
-  scope.define(st->identifier, {st->identifier, st->type, addr});
 }
 
 void CodeGenVisitor::visit(FunDecl* st) {
@@ -362,20 +1380,29 @@ void CodeGenVisitor::visit(FunDecl* st) {
   if (F && !F->empty()) abortMsg("redefine func");
 
   std::vector<llvm::Type*> args;
+  // an array parameter is a pointer to its first row
   for (auto [type, token] : st->args) {
-    auto t = l.getType(type);
-    if (t->isArrayTy()) {
-      // FIXME: hack, see all array type in funct proto as ptrs
-      t = t->getArrayElementType()->getPointerTo();
-    }
-    args.push_back(t);
+    type.isPointer |= type.isArray;
+    args.push_back(l.getType(type));
   }
 
   llvm::FunctionType* FT =
       llvm::FunctionType::get(l.getType(st->retType), args, false);
 
-  F = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+  F = llvm::Function::Create(FT,
+                             st->isStatic ? llvm::Function::InternalLinkage
+                                          : llvm::Function::ExternalLinkage,
                              st->identifier, l.mod.get());
+  l.addFPAttributes(F);
+  // a restrict parameter is the only way its target is accessed in the call
+  for (size_t i = 0; i < st->args.size(); i++) {
+    auto& t = st->args[i].type;
+    if (t.isRestrict || (t.isArray && options->argumentNoalias()))
+      F->addParamAttr(i, llvm::Attribute::NoAlias);
+  }
+  // the record keeps the return type, which the signedness of calls needs
+  if (!scope.count(st->identifier))
+    scope.define(st->identifier, {st->identifier, st->retType, F});
   if (st->body == nullptr) {  // a prototype
     size_t i = 0;
     for (auto& a : F->args()) {
@@ -390,8 +1417,12 @@ void CodeGenVisitor::visit(FunDecl* st) {
   llvm::BasicBlock* BB = llvm::BasicBlock::Create(*l.ctx, st->identifier, F);
   l.builder->SetInsertPoint(BB);
 
-  Trace r = {F, st};
+  std::unique_ptr<SSABuilder> ssa;
+  if (options->ssa()) ssa = std::make_unique<SSABuilder>();
+
+  Trace r = {F, st, nullptr, nullptr, ssa.get()};
   auto v = wrapWithTrace(&r);
+  v.seal(BB);
 
   // Set names for all arguments.
   size_t i = 0;
@@ -399,9 +1430,20 @@ void CodeGenVisitor::visit(FunDecl* st) {
     TypedVar formal = st->args[i++];
     std::string name = formal.id.lexeme;
     a.setName(name);
+    if (formal.type.isArray) {  // the pointer to the first row is the array
+      formal.type.isPointer = true;
+      v.scope.define(name, {name, formal.type, &a});
+      continue;
+    }
+    if (v.promotable(formal.type, name)) {
+      int var = ssa->declare(name, a.getType());
+      ssa->write(var, BB, &a);
+      v.scope.define(name, {name, formal.type, nullptr, var});
+      continue;
+    }
     auto addr = l.createEntryBlockAlloca(F, l.getType(formal.type),
                                          formal.id.lexeme.c_str());
-    l.builder->CreateStore(&a, addr);
+    l.setTBAA(l.builder->CreateStore(&a, addr), formal.type);
     v.scope.define(name, {name, formal.type, addr});
   }
 
@@ -412,6 +1454,11 @@ void CodeGenVisitor::visit(FunDecl* st) {
     l.builder->CreateRet(
         llvm::Constant::getIntegerValue(l.getInt(), llvm::APInt(32, 0)));
   }
+  // the dead block after a trailing __builtin_unreachable()
+  auto last = l.builder->GetInsertBlock();
+  if (!last->getTerminator() && llvm::pred_empty(last) &&
+      last != &F->getEntryBlock())
+    l.builder->CreateUnreachable();
   if (llvm::verifyFunction(*F, &llvm::errs()))
     ;  // abortMsg("verify error");
   // F->eraseFromParent();
@@ -444,6 +1491,8 @@ void CodeGenVisitor::visit(IfStmt* st) {
   llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(*l.ctx, "ifcont");
 
   l.builder->CreateCondBr(condV, thenBB, elseBB);
+  seal(thenBB);
+  seal(elseBB);
 
   // Emit then value.
   auto v1 = wrap();
@@ -470,6 +1519,35 @@ void CodeGenVisitor::visit(IfStmt* st) {
   // Emit merge block.
   fun->getBasicBlockList().push_back(mergeBB);
   l.builder->SetInsertPoint(mergeBB);
+  seal(mergeBB);
+}
+
+// The llvm.loop metadata carrying the pragma hints of a loop, or nullptr if
+// there are none. It belongs on the back edge.
+llvm::MDNode* CodeGenVisitor::loopID(const LoopHints& h) {
+  auto& ctx = *l.ctx;
+  std::vector<llvm::Metadata*> ops = {nullptr};  // the loop ID itself
+  auto hint = [&](const char* name, llvm::Value* v = nullptr) {
+    std::vector<llvm::Metadata*> md = {llvm::MDString::get(ctx, name)};
+    if (v) md.push_back(llvm::ConstantAsMetadata::get(
+               llvm::cast<llvm::Constant>(v)));
+    ops.push_back(llvm::MDNode::get(ctx, md));
+  };
+  if (h.unroll) hint("llvm.loop.unroll.enable");
+  if (h.unrollFull) hint("llvm.loop.unroll.full");
+  if (h.unrollCount == 1) hint("llvm.loop.unroll.disable");
+  if (h.unrollCount > 1)
+    hint("llvm.loop.unroll.count", l.builder->getInt32(h.unrollCount));
+  if (h.vectorize || h.vectorizeWidth > 1)
+    hint("llvm.loop.vectorize.enable", l.builder->getTrue());
+  if (h.vectorizeWidth)
+    hint("llvm.loop.vectorize.width", l.builder->getInt32(h.vectorizeWidth));
+  if (h.interleaveCount)
+    hint("llvm.loop.interleave.count", l.builder->getInt32(h.interleaveCount));
+  if (ops.size() == 1) return nullptr;
+  auto id = llvm::MDNode::getDistinct(ctx, ops);
+  id->replaceOperandWith(0, id);
+  return id;
 }
 
 void CodeGenVisitor::visit(WhileStmt* st) {
@@ -485,7 +1563,12 @@ void CodeGenVisitor::visit(WhileStmt* st) {
   CodeGenVisitor v(scope, l);
   l.builder->SetInsertPoint(beginB);
   v.visit(st->condition);
-  l.builder->CreateCondBr(l.convertToTruthy(v.getValue()), bodyB, endB);
+  auto condV = l.convertToTruthy(v.getValue());
+  if (auto c = llvm::dyn_cast<llvm::ConstantInt>(condV))
+    l.builder->CreateBr(c->isZero() ? endB : bodyB);
+  else
+    l.builder->CreateCondBr(condV, bodyB, endB);
+  seal(bodyB);
 
   // emit the body
   auto t = scope.getTrace();
@@ -496,16 +1579,90 @@ void CodeGenVisitor::visit(WhileStmt* st) {
   l.builder->SetInsertPoint(bodyB);
   v1.visit(st->body);
   if (!v1.terminate) l.builder->CreateBr(contB);
+  seal(contB);  // after the body, all the `continue`s are known
 
   // set inserter to contB
   l.builder->SetInsertPoint(contB);
   f->getBasicBlockList().push_back(contB);
   if (st->update) v1.visit(st->update);
-  l.builder->CreateBr(beginB);
+  auto backEdge = l.builder->CreateBr(beginB);
+  if (auto id = loopID(st->hints))
+    backEdge->setMetadata(llvm::LLVMContext::MD_loop, id);
+  seal(beginB);  // the back edge is emitted
 
   // set inserter to endB
   l.builder->SetInsertPoint(endB);
   f->getBasicBlockList().push_back(endB);
+  seal(endB);
+}
+
+void CodeGenVisitor::visit(SwitchStmt* st) {
+  CodeGenVisitor v(scope, l);
+  v.visit(st->condition);
+  if (!v.getValue()->getType()->isIntegerTy())
+    abortMsg("switch condition is not an integer");
+  // the labels are compared with the promoted condition
+  auto condV = promote(v.getOperand()).value;
+
+  auto f = l.builder->GetInsertBlock()->getParent();
+  auto endB = llvm::BasicBlock::Create(*l.ctx, "switchEnd");
+
+  // consecutive labels share a block, so `case 1: case 2:` is one target
+  auto& cases = st->cases;
+  std::vector<llvm::BasicBlock*> blocks(cases.size());
+  llvm::BasicBlock* defaultB = endB;
+  for (int i = cases.size() - 1; i >= 0; i--) {
+    if (cases[i].body.empty() && i + 1 < (int)cases.size())
+      blocks[i] = blocks[i + 1];
+    else
+      blocks[i] = llvm::BasicBlock::Create(
+          *l.ctx, cases[i].label ? "switchCase" : "switchDefault");
+    if (!cases[i].label) defaultB = blocks[i];
+  }
+
+  auto sw = l.builder->CreateSwitch(condV, defaultB, cases.size());
+  for (size_t i = 0; i < cases.size(); i++) {
+    if (!cases[i].label) continue;
+    CodeGenVisitor lv(scope, l);
+    lv.visit(cases[i].label);
+    auto c = llvm::dyn_cast<llvm::ConstantInt>(lv.getValue());
+    if (!c) abortMsg("case label is not an integer constant");
+    auto width = condV->getType()->getIntegerBitWidth();
+    bool zext = lv.isUnsigned || c->getType() == l.getBool();
+    if (c->getBitWidth() > width &&
+        !(zext ? c->getValue().isIntN(width)
+               : c->getValue().isSignedIntN(width)))
+      abortMsg("case label value is out of the range of the condition");
+    auto label = llvm::ConstantInt::get(
+        *l.ctx, zext ? c->getValue().zextOrTrunc(width)
+                     : c->getValue().sextOrTrunc(width));
+    if (sw->findCaseValue(label) != sw->case_default())
+      abortMsg("duplicate case value");
+    sw->addCase(label, blocks[i]);
+  }
+
+  // `break` leaves the switch, `continue` still refers to the enclosing loop
+  auto t = scope.getTrace();
+  t.endB = endB;
+  auto v1 = wrapWithTrace(&t);
+  for (size_t i = 0; i < cases.size(); i++) {
+    if (i + 1 < cases.size() && blocks[i] == blocks[i + 1]) continue;
+    // the previous case, which may fall through, is emitted
+    f->getBasicBlockList().push_back(blocks[i]);
+    l.builder->SetInsertPoint(blocks[i]);
+    seal(blocks[i]);
+    v1.terminate = false;
+    for (auto d : cases[i].body) {
+      v1.visit(d);
+      if (v1.terminate) break;
+    }
+    if (!v1.terminate)
+      l.builder->CreateBr(i + 1 < cases.size() ? blocks[i + 1] : endB);
+  }
+
+  f->getBasicBlockList().push_back(endB);
+  l.builder->SetInsertPoint(endB);
+  seal(endB);
 }
 
 void CodeGenVisitor::visit(BreakStmt* st) {
@@ -536,7 +1693,8 @@ void CodeGenVisitor::visit(ReturnStmt* st) {
   CodeGenVisitor v(scope, l);
   if (st->expr) {
     v.visit(st->expr);
-    auto val = l.implictConvert(v.getValue(), t.llvmFun->getReturnType());
+    auto val = l.implictConvert(v.getValue(), t.llvmFun->getReturnType(),
+                                v.isUnsigned);
     l.builder->CreateRet(val);
   } else {
     l.builder->CreateRetVoid();
@@ -648,6 +1806,25 @@ void GraphGenVisitor::visit(WhileStmt* d) {
   rootNode = node;
 }
 
+void GraphGenVisitor::visit(SwitchStmt* d) {
+  int node = addNode("switch");
+  visit(d->getCondition());
+  addTo(rootNode, node);
+  for (auto& c : d->getCases()) {
+    int caseNode = addNode(c.label ? "case" : "default");
+    if (c.label) {
+      visit(c.label);
+      addTo(rootNode, caseNode);
+    }
+    for (auto s : c.body) {
+      visit(s);
+      addTo(rootNode, caseNode);
+    }
+    addTo(caseNode, node);
+  }
+  rootNode = node;
+}
+
 void GraphGenVisitor::visit(BreakStmt* d) { rootNode = addNode("break"); }
 
 void GraphGenVisitor::visit(ContStmt* d) { rootNode = addNode("continue"); }
@@ -677,6 +1854,10 @@ void GraphGenVisitor::visit(Double* expr) {
   rootNode = addNode(std::string(*expr));
 }
 
+void GraphGenVisitor::visit(Float* expr) {
+  rootNode = addNode(std::string(*expr));
+}
+
 void GraphGenVisitor::visit(String* expr) {
   rootNode = addNode(std::string(*expr));
 }
@@ -700,6 +1881,40 @@ void GraphGenVisitor::visit(Binary* expr) {
   rootNode = root;
 }
 
+void GraphGenVisitor::visit(Conditional* expr) {
+  int root = addNode("?:");
+
+  visit(expr->getCond());
+  int c = rootNode;
+
+  visit(expr->getThen());
+  int t = rootNode;
+
+  visit(expr->getElse());
+  int e = rootNode;
+
+  addTo(c, root);
+  addTo(t, root);
+  addTo(e, root);
+
+  rootNode = root;
+}
+
+void GraphGenVisitor::visit(Logical* expr) {
+  int root = addNode(expr->getOp().lexeme);
+
+  visit(expr->getLeft());
+  int l = rootNode;
+
+  visit(expr->getRight());
+  int r = rootNode;
+
+  addTo(l, root);
+  addTo(r, root);
+
+  rootNode = root;
+}
+
 void GraphGenVisitor::visit(Unary* expr) {
   int node = addNode(expr->getOp().lexeme);
   visit(expr->getChild());
@@ -707,9 +1922,25 @@ void GraphGenVisitor::visit(Unary* expr) {
   rootNode = node;
 }
 
-void GraphGenVisitor::visit(Postfix* expr) {
-  int node = addNode(expr->getOp().lexeme);
-  visit(expr->getChild());
+void GraphGenVisitor::visit(CompoundAssign* expr) {
+  int root = addNode(expr->getOp().lexeme);
+
+  visit(expr->getTarget());
+  int l = rootNode;
+
+  visit(expr->getValue());
+  int r = rootNode;
+
+  addTo(l, root);
+  addTo(r, root);
+
+  rootNode = root;
+}
+
+void GraphGenVisitor::visit(IncDec* expr) {
+  int node = addNode(expr->isPrefix() ? expr->getOp().lexeme + " (prefix)"
+                                      : expr->getOp().lexeme + " (postfix)");
+  visit(expr->getTarget());
   addTo(rootNode, node);
   rootNode = node;
 }
@@ -731,6 +1962,15 @@ void GraphGenVisitor::visit(Call* expr) {
   rootNode = node;
 }
 
+void GraphGenVisitor::visit(InitList* expr) {
+  int node = addNode("{}");
+  for (auto e : expr->getElems()) {
+    visit(e);
+    addTo(rootNode, node);
+  }
+  rootNode = node;
+}
+
 void GraphGenVisitor::visit(Index* expr) {
   int node = addNode("[]");
 
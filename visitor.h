@@ -5,12 +5,17 @@
 class Expr;
 class Literal;
 class Binary;
+class Logical;
+class Conditional;
 class Unary;
-class Postfix;
+class CompoundAssign;
+class IncDec;
 class Variable;
 class Call;
 class Index;
+class InitList;
 class Double;
+class Float;
 class Integer;
 class Boolean;
 class Char;
@@ -26,6 +31,8 @@ class BlockStmt;
 class IfStmt;
 class ForStmt;
 class WhileStmt;
+struct LoopHints;
+class SwitchStmt;
 class BreakStmt;
 class ContStmt;
 class ReturnStmt;
@@ -38,15 +45,20 @@ class AstVisitor {
   virtual void visit(Literal* expr) = 0;
   virtual void visit(Integer* expr) = 0;
   virtual void visit(Double* expr) = 0;
+  virtual void visit(Float* expr) = 0;
   virtual void visit(Boolean* expr) = 0;
   virtual void visit(Char* expr) = 0;
   virtual void visit(String* expr) = 0;
   virtual void visit(Binary* expr) = 0;
+  virtual void visit(Logical* expr) = 0;
+  virtual void visit(Conditional* expr) = 0;
   virtual void visit(Unary* expr) = 0;
-  virtual void visit(Postfix* expr) = 0;
+  virtual void visit(CompoundAssign* expr) = 0;
+  virtual void visit(IncDec* expr) = 0;
   virtual void visit(Variable* expr) = 0;
   virtual void visit(Call* expr) = 0;
   virtual void visit(Index* expr) = 0;
+  virtual void visit(InitList* expr) = 0;
 
   virtual void visit(Declaration* d) = 0;
   virtual void visit(ExprStmt* st) = 0;
@@ -55,20 +67,49 @@ class AstVisitor {
   virtual void visit(BlockStmt* d) = 0;
   virtual void visit(IfStmt* d) = 0;
   virtual void visit(WhileStmt* d) = 0;
+  virtual void visit(SwitchStmt* d) = 0;
   virtual void visit(BreakStmt* d) = 0;
   virtual void visit(ContStmt* d) = 0;
   virtual void visit(ReturnStmt* d) = 0;
 };
 
+// A generated value with its signedness, which llvm::Value* doesn't carry.
+struct Operand {
+  llvm::Value* value;
+  bool isUnsigned;
+};
+
 class CodeGenVisitor : public AstVisitor {
   Scope scope;
   llvmWrapper l;
   llvm::Value* value = nullptr;
-  llvm::AllocaInst* addr = nullptr;
-  Type type = {};  // only used for array. other type information is passed by
-                   // llvm::Value*
+  llvm::Value* addr = nullptr;
+  int ssaVar = -1;  // the SSA variable named by the last expression, if any
+  Type type = {};  // only used for arrays and pointers. other type information
+                   // is passed by llvm::Value*
+  bool isUnsigned = false;  // signedness of an integer value
+  bool readOnly = false;    // the lvalue is const
   bool terminate = false;
 
+  Operand promote(Operand o);
+  Operand binaryOp(Token op, Operand lhs, Operand rhs);
+  Operand pointerOp(Token op, Operand lhs, Operand rhs);
+  Operand vectorOp(Token op, Operand lhs, Operand rhs);
+  std::pair<llvm::Value*, llvm::Value*> vectorOperands(Operand lhs,
+                                                       Operand rhs);
+  bool builtin(const std::string& name, const std::vector<Expr*>& args);
+  bool intrinsic(const std::string& name, const std::vector<Expr*>& args);
+  bool noSignedWrap(llvm::Type* t, bool isUnsigned);
+  llvm::MDNode* loopID(const LoopHints& h);
+  bool promotable(const Type& t, const std::string& name);
+  void seal(llvm::BasicBlock* b);
+  void defineGlobal(VarDecl* st, const Type& t);
+  llvm::Value* initValue(const Type& t, Expr* init);
+  std::vector<llvm::Value*> arrayInit(const Type& t, Expr* init);
+  void initArray(Type t, llvm::AllocaInst* addr, Expr* init);
+  void flattenInit(InitList* list, const Type& t, size_t level, size_t begin,
+                   size_t end, std::vector<llvm::Value*>& flat);
+
  public:
   CodeGenVisitor(Scope scope, llvmWrapper l) : scope(scope), l(l) {
     value = nullptr;
@@ -90,6 +131,7 @@ class CodeGenVisitor : public AstVisitor {
   void visit(BlockStmt* d) override;
   void visit(IfStmt* d) override;
   void visit(WhileStmt* d) override;
+  void visit(SwitchStmt* d) override;
   void visit(BreakStmt* d) override;
   void visit(ContStmt* d) override;
   void visit(ReturnStmt* d) override;
@@ -98,27 +140,45 @@ class CodeGenVisitor : public AstVisitor {
   void visit(Literal* expr) override;
   void visit(Integer* expr) override;
   void visit(Double* expr) override;
+  void visit(Float* expr) override;
   void visit(Boolean* expr) override;
   void visit(Char* expr) override;
   void visit(String* expr) override;
   void visit(Binary* expr) override;
+  void visit(Logical* expr) override;
+  void visit(Conditional* expr) override;
   void visit(Unary* expr) override;
-  void visit(Postfix* expr) override;
+  void visit(CompoundAssign* expr) override;
+  void visit(IncDec* expr) override;
   void visit(Variable* expr) override;
   void visit(Call* expr) override;
   void visit(Index* expr) override;
+  void visit(InitList* expr) override;
 
   Type getType() { return type; }
   void setType(Type t) { type = t; }
-  void setValue(llvm::Value* v) { value = v; }
-  void setAddr(llvm::AllocaInst* a) { addr = a; }
-  void setTuple(llvm::Value* v, llvm::AllocaInst* a = nullptr) {
+  void setValue(llvm::Value* v) {
+    value = v;
+    isUnsigned = false;
+  }
+  void setAddr(llvm::Value* a) {
+    addr = a;
+    ssaVar = -1;
+    readOnly = false;
+  }
+  void setTuple(llvm::Value* v, llvm::Value* a = nullptr) {
     value = v;
     addr = a;
+    ssaVar = -1;
+    isUnsigned = false;
+    readOnly = false;
   }
+  bool isLval() { return addr || ssaVar >= 0; }
+  void assign(llvm::Value* v);
 
   llvm::Value* getValue() { return value; }
-  llvm::AllocaInst* getAddr() { return addr; }
+  Operand getOperand() { return {value, isUnsigned}; }
+  llvm::Value* getAddr() { return addr; }
 };
 
 class GraphGenVisitor : public AstVisitor {
@@ -142,6 +202,7 @@ class GraphGenVisitor : public AstVisitor {
   void visit(BlockStmt* d) override;
   void visit(IfStmt* d) override;
   void visit(WhileStmt* d) override;
+  void visit(SwitchStmt* d) override;
   void visit(BreakStmt* d) override;
   void visit(ContStmt* d) override;
   void visit(ReturnStmt* d) override;
@@ -150,13 +211,18 @@ class GraphGenVisitor : public AstVisitor {
   void visit(Literal* expr) override;
   void visit(Integer* expr) override;
   void visit(Double* expr) override;
+  void visit(Float* expr) override;
   void visit(Boolean* expr) override;
   void visit(Char* expr) override;
   void visit(String* expr) override;
   void visit(Binary* expr) override;
+  void visit(Logical* expr) override;
+  void visit(Conditional* expr) override;
   void visit(Unary* expr) override;
-  void visit(Postfix* expr) override;
+  void visit(CompoundAssign* expr) override;
+  void visit(IncDec* expr) override;
   void visit(Variable* expr) override;
   void visit(Call* expr) override;
   void visit(Index* expr) override;
+  void visit(InitList* expr) override;
 };